@@ -0,0 +1,196 @@
+/*
+ * Aggregate acquisition throughput with ADC_DEVICES simulated converters.
+ *
+ * Every converter is a SimulatedAD7124 at speedup 0, so a conversion completes as
+ * soon as its driver waits for it, behind the bus arbiter and with one AD7124
+ * driver and acquisition thread each, as in main(). A consumer thread drains
+ * the windows and returns them to the pool at once, so the figures are those of the
+ * acquisition path alone: SPI protocol, arbitration, DRDY handling, filtering,
+ * decimation and window hand-off. With COOPERATIVE_SCHEDULING the reads, blocks
+ * and the consumer are handlers of the EventLoop on one loop thread. The latency
+ * of a window is the time from its hand-off by acquisition until it is consumed.
+ *
+ * Usage: bench_acquisition_<N> [seconds] [decimation ratio], bench_acquisition_cooperative_<N> ...
+ */
+
+#include "mbed.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include "adc/AD7124.h"
+#include "adc/AD7124BusArbiter.h"
+#include "adc/SimulatedAD7124.h"
+#include "interfaces/EventLoop.h"
+#include "interfaces/ReadingQueue.h"
+#include "interfaces/WindowPool.h"
+#include "preprocessing/Decimator.h"
+#include "utils/constants.h"
+
+#define BENCH_SECONDS 5
+#define BENCH_DECIMATION 2 // conversions per window value, the smallest ratio hands on a window per two conversions of each channel
+#define BENCH_MEDIAN_WINDOW 7
+#define BENCH_SPIKE_THRESHOLD 0
+
+static SimulatedAD7124* buses[ADC_DEVICES];
+static AD7124BusArbiter* arbiter;
+static AD7124* drivers[ADC_DEVICES];
+#ifdef COOPERATIVE_SCHEDULING
+static Thread loop_thread;
+#else
+static Thread acquisition_threads[ADC_DEVICES];
+static Thread consumer_thread;
+#endif
+static unsigned int decimation_ratio = BENCH_DECIMATION;
+static std::atomic<uint32_t> windows(0);
+static std::atomic<uint64_t> total_latency_us(0);
+static std::atomic<uint32_t> max_latency_us(0);
+
+static void release(WindowPool::Buffer* window){
+    WindowPool& pool = WindowPool::getInstance();
+    const uint32_t latency_us = pool.get_time_us() - window->timestamp_us;
+    total_latency_us += latency_us;
+    if (latency_us > max_latency_us){
+        max_latency_us = latency_us;
+    }
+    pool.release(window);
+    windows++;
+}
+
+static void acquire(int device){
+    AD7124& adc = *drivers[device];
+    if (!adc.configure(adc.get_configuration())){
+        fprintf(stderr, "ADC %d configuration failed\n", device);
+        std::quick_exit(EXIT_FAILURE);
+    }
+    adc.read_voltage_from_channels(decimation_ratio, BENCH_MEDIAN_WINDOW, BENCH_SPIKE_THRESHOLD);
+}
+
+#ifdef COOPERATIVE_SCHEDULING
+static void consume_next(void){
+    WindowPool::Buffer* window = ReadingQueue::getInstance().queue.try_get();
+    if (window != nullptr){
+        AD7124::resume_parked();
+        release(window);
+    }
+}
+
+static void notify(void){
+    EventLoop::getInstance().post(callback(consume_next));
+}
+#else
+static void consume(void){
+    ReadingQueue& reading_queue = ReadingQueue::getInstance();
+    while (true){
+        release(reading_queue.queue.get());
+    }
+}
+#endif
+
+static uint64_t conversions(void){
+    uint64_t count = 0;
+    for (int device = 0; device < ADC_DEVICES; device++){
+        count += buses[device]->get_conversion_count();
+    }
+    return count;
+}
+
+/// Conversions the acquisition thread of a device filtered and decimated.
+static uint32_t processed(int device){
+    AcquisitionStats::Statistics statistics[ADC_CHANNELS];
+    drivers[device]->get_acquisition_statistics(statistics);
+    uint32_t count = 0;
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        count += statistics[channel].total_count;
+    }
+    return count;
+}
+
+int main(int argc, char* argv[]){
+    const int seconds = argc > 1 ? atoi(argv[1]) : BENCH_SECONDS;
+    if (argc > 2){
+        decimation_ratio = static_cast<unsigned int>(atoi(argv[2]));
+        if (decimation_ratio < 2 || decimation_ratio > Decimator::MAX_RATIO || decimation_ratio % 2 != 0){
+            fprintf(stderr, "The decimation ratio must be even, 2 to %u\n", Decimator::MAX_RATIO);
+            return EXIT_FAILURE;
+        }
+    }
+
+    AD7124Bus* devices[ADC_DEVICES];
+    for (int device = 0; device < ADC_DEVICES; device++){
+        buses[device] = new SimulatedAD7124(0);
+        devices[device] = buses[device];
+    }
+    arbiter = new AD7124BusArbiter(devices);
+    for (int device = 0; device < ADC_DEVICES; device++){
+        drivers[device] = new AD7124(arbiter->port(device), static_cast<uint8_t>(device));
+    }
+
+#ifdef COOPERATIVE_SCHEDULING
+    ReadingQueue::getInstance().queue.set_notify(callback(notify));
+    for (int device = 0; device < ADC_DEVICES; device++){
+        acquire(device);
+    }
+    loop_thread.start(callback(&EventLoop::getInstance(), &EventLoop::dispatch));
+#else
+    consumer_thread.start(callback(consume));
+    for (int device = 0; device < ADC_DEVICES; device++){
+        acquisition_threads[device].start([device]() { acquire(device); });
+    }
+#endif
+
+    // Configuration and the first window are not measured
+    ThisThread::sleep_for(std::chrono::milliseconds(500));
+    Timer timer;
+    const uint64_t first_conversions = conversions();
+    uint32_t first_processed[ADC_DEVICES];
+    for (int device = 0; device < ADC_DEVICES; device++){
+        first_processed[device] = processed(device);
+    }
+    const uint32_t first_windows = windows;
+    const uint64_t first_latency_us = total_latency_us;
+    max_latency_us = 0;
+    const std::clock_t first_cpu = std::clock();
+    timer.start();
+
+    ThisThread::sleep_for(std::chrono::seconds(seconds));
+
+    const float elapsed = timer.elapsed_time().count() / 1e6f;
+    const uint64_t converted = conversions() - first_conversions;
+    const uint32_t handed_on = windows - first_windows;
+    const uint64_t latency_us = total_latency_us - first_latency_us;
+    const float busy = static_cast<float>(std::clock() - first_cpu) / CLOCKS_PER_SEC / elapsed;
+
+    uint64_t total_processed = 0;
+    uint32_t device_processed[ADC_DEVICES];
+    for (int device = 0; device < ADC_DEVICES; device++){
+        device_processed[device] = processed(device) - first_processed[device];
+        total_processed += device_processed[device];
+    }
+
+    // At speedup 0 the DRDY threads (or asynchronous reads) read conversions faster than the
+    // acquisition threads (or blocks) process them, the difference overflows the conversion rings
+#ifdef COOPERATIVE_SCHEDULING
+    const char* mode = "cooperative";
+#else
+    const char* mode = "threaded";
+#endif
+    printf("devices %d, channels %d, %s, decimation %u, %.1f s\n", ADC_DEVICES, ADC_CHANNELS, mode, decimation_ratio,
+           elapsed);
+    printf("aggregate %.0f conversions/s read, %.0f samples/s processed, %.0f windows/s\n",
+           converted / elapsed, total_processed / elapsed, handed_on / elapsed);
+    printf("window latency mean/max %.0f/%lu us\n", handed_on > 0 ? static_cast<float>(latency_us) / handed_on : 0.0f,
+           static_cast<unsigned long>(max_latency_us));
+    for (int device = 0; device < ADC_DEVICES; device++){
+        printf("device %d: %.0f samples/s processed, %lu conversions overwritten before read\n", device,
+               device_processed[device] / elapsed, static_cast<unsigned long>(buses[device]->get_missed_count()));
+    }
+    // CPU time of all threads per wall time, above 100 % once several cores run them
+    printf("cpu %.0f %%\n", busy * 100.0f);
+    fflush(stdout);
+
+    // The acquisition threads loop forever
+    std::quick_exit(EXIT_SUCCESS);
+}
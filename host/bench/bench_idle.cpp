@@ -0,0 +1,159 @@
+/*
+ * CPU load of the acquisition while it waits for conversions.
+ *
+ * ADC_DEVICES simulated converters run in real time (speedup 1) with the
+ * configuration and decimation of main(), so the acquisition threads spend almost
+ * all of their time waiting for DRDY. Every wait should sleep: the process CPU
+ * time per wall time stays at a few percent, while a thread that polls or spins
+ * shows as a large share of a core. The benchmark fails above
+ * BENCH_BUSY_WAIT_LIMIT.
+ *
+ * The stacks the threads reserve on the board are reported for the scheduling mode. With
+ * COOPERATIVE_SCHEDULING the handlers of all converters and the consumer run on
+ * one loop thread, standing in for main().
+ *
+ * Usage: bench_idle_<N> [seconds], bench_idle_cooperative_<N> [seconds]
+ */
+
+#include "mbed.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include "adc/AD7124.h"
+#include "adc/AD7124BusArbiter.h"
+#include "adc/SimulatedAD7124.h"
+#include "interfaces/EventLoop.h"
+#include "interfaces/ReadingQueue.h"
+#include "interfaces/WindowPool.h"
+#include "preprocessing/Decimator.h"
+#include "utils/constants.h"
+
+#define BENCH_SECONDS 10
+#define BENCH_BUSY_WAIT_LIMIT 10 // percent of one core
+
+// As in main.cpp
+#define DOWNSAMPLING_RATE 600
+#define MEDIAN_WINDOW 7
+#define SPIKE_THRESHOLD 0
+#define ADC_POWER_MODE AD7124::PowerMode::Low
+#define ADC_FILTER AD7124::FilterType::Sinc4
+#define ADC_FILTER_FS 6
+#define ADC_PGA_GAIN AD7124::PgaGain::x4
+
+static AD7124BusArbiter* arbiter;
+static AD7124* drivers[ADC_DEVICES];
+#ifdef COOPERATIVE_SCHEDULING
+static Thread loop_thread;
+#else
+static Thread acquisition_threads[ADC_DEVICES];
+static Thread consumer_thread;
+#endif
+
+static void acquire(int device){
+    AD7124& adc = *drivers[device];
+    AD7124::Configuration configuration = adc.get_configuration();
+    configuration.power_mode = ADC_POWER_MODE;
+    for (AD7124::SetupConfig& setup : configuration.setups){
+        setup.filter = ADC_FILTER;
+        setup.filter_select = ADC_FILTER_FS;
+        setup.gain = ADC_PGA_GAIN;
+    }
+    if (!adc.configure(configuration)){
+        fprintf(stderr, "ADC %d configuration failed\n", device);
+        std::quick_exit(EXIT_FAILURE);
+    }
+    const unsigned int decimation_ratio =
+        Decimator::ratio_for_period(adc.get_channel_data_rate(), static_cast<float>(DOWNSAMPLING_RATE) / VECTOR_SIZE);
+    adc.read_voltage_from_channels(decimation_ratio, MEDIAN_WINDOW, SPIKE_THRESHOLD);
+}
+
+#ifdef COOPERATIVE_SCHEDULING
+static void consume_next(void){
+    WindowPool::Buffer* window = ReadingQueue::getInstance().queue.try_get();
+    if (window != nullptr){
+        AD7124::resume_parked();
+        WindowPool::getInstance().release(window);
+    }
+}
+
+static void notify(void){
+    EventLoop::getInstance().post(callback(consume_next));
+}
+#else
+static void consume(void){
+    ReadingQueue& reading_queue = ReadingQueue::getInstance();
+    WindowPool& pool = WindowPool::getInstance();
+    while (true){
+        pool.release(reading_queue.queue.get());
+    }
+}
+#endif
+
+int main(int argc, char* argv[]){
+    const int seconds = argc > 1 ? atoi(argv[1]) : BENCH_SECONDS;
+
+    AD7124Bus* devices[ADC_DEVICES];
+    for (int device = 0; device < ADC_DEVICES; device++){
+        devices[device] = new SimulatedAD7124(1);
+    }
+    arbiter = new AD7124BusArbiter(devices);
+    for (int device = 0; device < ADC_DEVICES; device++){
+        drivers[device] = new AD7124(arbiter->port(device), static_cast<uint8_t>(device));
+    }
+
+#ifdef COOPERATIVE_SCHEDULING
+    // The converters are set up before the loop runs, as in main()
+    ReadingQueue::getInstance().queue.set_notify(callback(notify));
+    for (int device = 0; device < ADC_DEVICES; device++){
+        acquire(device);
+    }
+    loop_thread.start(callback(&EventLoop::getInstance(), &EventLoop::dispatch));
+#else
+    consumer_thread.start(callback(consume));
+    for (int device = 0; device < ADC_DEVICES; device++){
+        acquisition_threads[device].start([device]() { acquire(device); });
+    }
+#endif
+
+    // Configuration is not measured
+    ThisThread::sleep_for(std::chrono::seconds(1));
+    Timer timer;
+    const std::clock_t first_cpu = std::clock();
+    timer.start();
+
+    ThisThread::sleep_for(std::chrono::seconds(seconds));
+
+    const float elapsed = timer.elapsed_time().count() / 1e6f;
+    const float busy = static_cast<float>(std::clock() - first_cpu) / CLOCKS_PER_SEC / elapsed * 100.0f;
+
+    uint32_t read = 0;
+    for (int device = 0; device < ADC_DEVICES; device++){
+        AcquisitionStats::Statistics statistics[ADC_CHANNELS];
+        drivers[device]->get_acquisition_statistics(statistics);
+        for (int channel = 0; channel < ADC_CHANNELS; channel++){
+            read += statistics[channel].total_count;
+        }
+    }
+
+    // Stacks as the threads request them on the board, the host ignores the sizes
+    mbed_stats_stack_t stacks;
+    mbed_stats_stack_get(&stacks);
+
+#ifdef COOPERATIVE_SCHEDULING
+    const char* mode = "cooperative";
+#else
+    const char* mode = "threaded";
+#endif
+    printf("devices %d, channels %d, %s, %.1f s, %lu conversions processed\n", ADC_DEVICES, ADC_CHANNELS, mode,
+           elapsed, static_cast<unsigned long>(read));
+    printf("stacks %lu bytes reserved in %lu threads\n", static_cast<unsigned long>(stacks.reserved_size),
+           static_cast<unsigned long>(stacks.stack_cnt));
+    printf("cpu %.1f %% of one core, limit %d %%: %s\n", busy, BENCH_BUSY_WAIT_LIMIT,
+           busy <= BENCH_BUSY_WAIT_LIMIT ? "every wait sleeps" : "busy-wait suspected");
+    fflush(stdout);
+
+    // The acquisition threads loop forever
+    std::quick_exit(busy <= BENCH_BUSY_WAIT_LIMIT ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,81 @@
+/*
+ * Throughput of the float and the Q15 normalisation path.
+ *
+ * A window of VECTOR_SIZE values slides by one value per step, as with a hop
+ * of 1 in main(), and is normalised by AdaptiveNormalizer::process() and by
+ * process_q15() in turn. The host has a double precision FPU and a 64-bit
+ * multiplier, so the ratio of both paths is not that of the Cortex-M4; the
+ * figures compare changes to either path.
+ *
+ * Usage: bench_preprocessing [windows]
+ */
+
+#include "mbed.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "preprocessing/AdaptiveNormalizer.h"
+#include "utils/Conversion.h"
+#include "utils/FixedPoint.h"
+#include "utils/constants.h"
+
+#define BENCH_WINDOWS 200000
+#define BENCH_BLOCK_COUNT 24        // horizon as in main()
+#define BENCH_BLOCK_LENGTH 600
+#define BENCH_MIN_SPAN 0.4f
+#define DATABITS 8388608
+#define VREF 2.5f
+#define GAIN 4.0f
+
+static const double PI = 3.14159265358979323846;
+
+// A slow sine with a few codes of noise
+static std::array<uint8_t, 3> sample(std::size_t i){
+    return signed_code_to_bytes(static_cast<int32_t>(2000.0 * std::sin(2.0 * PI * i / 700.0)) + static_cast<int32_t>(i * 7 % 31));
+}
+
+int main(int argc, char* argv[]){
+    const long windows = argc > 1 ? atol(argv[1]) : BENCH_WINDOWS;
+    if (windows < 1){
+        fprintf(stderr, "The number of windows must be at least 1\n");
+        return EXIT_FAILURE;
+    }
+
+    // The signal is converted up front, only the normalisation is measured
+    std::vector<std::array<uint8_t, 3>> trace(windows + VECTOR_SIZE);
+    for (std::size_t i = 0; i < trace.size(); i++){
+        trace[i] = sample(i);
+    }
+
+    AdaptiveNormalizer float_path(BENCH_BLOCK_COUNT, BENCH_BLOCK_LENGTH, BENCH_MIN_SPAN, DATABITS, VREF, GAIN);
+    AdaptiveNormalizer fixed_path(BENCH_BLOCK_COUNT, BENCH_BLOCK_LENGTH, BENCH_MIN_SPAN, DATABITS, VREF, GAIN);
+    std::vector<float> float_outputs;
+    std::vector<q15_t> fixed_outputs;
+    float float_sum = 0.0f;
+    long fixed_sum = 0;
+
+    Timer timer;
+    timer.start();
+    for (long n = 0; n < windows; n++){
+        float_path.process(&trace[n], VECTOR_SIZE, (n == 0) ? VECTOR_SIZE : 1, 1.0f, float_outputs);
+        float_sum += float_outputs[VECTOR_SIZE - 1];
+    }
+    const double float_us = static_cast<double>(timer.elapsed_time().count());
+
+    timer.reset();
+    for (long n = 0; n < windows; n++){
+        fixed_path.process_q15(&trace[n], VECTOR_SIZE, (n == 0) ? VECTOR_SIZE : 1, fixed_outputs);
+        fixed_sum += fixed_outputs[VECTOR_SIZE - 1];
+    }
+    const double fixed_us = static_cast<double>(timer.elapsed_time().count());
+
+    // The sums keep the compiler from dropping the loops
+    printf("%ld windows of %d values (checksums %.1f, %ld)\n", windows, VECTOR_SIZE, float_sum, fixed_sum);
+    printf("float: %.1f ns per window, %.2f ns per value\n", float_us * 1e3 / windows, float_us * 1e3 / windows / VECTOR_SIZE);
+    printf("q15:   %.1f ns per window, %.2f ns per value\n", fixed_us * 1e3 / windows, fixed_us * 1e3 / windows / VECTOR_SIZE);
+    return EXIT_SUCCESS;
+}
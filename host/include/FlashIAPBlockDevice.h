@@ -0,0 +1,38 @@
+// FlashIAPBlockDevice.h
+#ifndef MBED_HOST_FLASHIAP_BLOCK_DEVICE_H
+#define MBED_HOST_FLASHIAP_BLOCK_DEVICE_H
+
+#include <cstdint>
+#include <mutex>
+
+#include "utils/FileBlockDevice.h"
+
+// Matches flashiap-block-device.size in mbed_app.json5
+#ifndef MBED_CONF_FLASHIAP_BLOCK_DEVICE_SIZE
+#define MBED_CONF_FLASHIAP_BLOCK_DEVICE_SIZE 16384
+#endif
+
+/**
+ * @class FlashIAPBlockDevice
+ * @brief The internal flash behind the application, kept in a file on the host.
+ *
+ * The file is the path in PHYTO_FLASH_FILE, or flashiap.bin in the working
+ * directory, so calibrations persist across runs as they do across resets.
+ * Like FlashIAP, accesses are serialised, the drivers of all converters share it.
+ */
+class FlashIAPBlockDevice: public FileBlockDevice {
+    public:
+        explicit FlashIAPBlockDevice(uint32_t address = 0, uint32_t size = MBED_CONF_FLASHIAP_BLOCK_DEVICE_SIZE);
+
+        int init(void) override;
+        int deinit(void) override;
+        int read(void* buffer, bd_addr_t address, bd_size_t size) override;
+        int program(const void* buffer, bd_addr_t address, bd_size_t size) override;
+        int erase(bd_addr_t address, bd_size_t size) override;
+        const char* get_type(void) const override;
+
+    private:
+        std::mutex m_mutex;
+};
+
+#endif // MBED_HOST_FLASHIAP_BLOCK_DEVICE_H
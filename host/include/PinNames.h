@@ -0,0 +1,30 @@
+// PinNames.h
+#ifndef MBED_HOST_PIN_NAMES_H
+#define MBED_HOST_PIN_NAMES_H
+
+/// Pins of the NUCLEO-WB55RG the firmware refers to. On the host they name nothing.
+typedef enum {
+    PA_0 = 0x00, PA_1, PA_2, PA_3, PA_4, PA_5, PA_6, PA_7,
+    PA_8, PA_9, PA_10, PA_11, PA_12, PA_13, PA_14, PA_15,
+    PB_0 = 0x10, PB_1, PB_2, PB_3, PB_4, PB_5, PB_6, PB_7,
+    PB_8, PB_9, PB_10, PB_11, PB_12, PB_13, PB_14, PB_15,
+    PC_0 = 0x20, PC_1, PC_2, PC_3, PC_4, PC_5, PC_6, PC_7,
+    PC_8, PC_9, PC_10, PC_11, PC_12, PC_13, PC_14, PC_15,
+
+    CONSOLE_TX = PB_6,
+    CONSOLE_RX = PB_7,
+    USBTX = CONSOLE_TX,
+    USBRX = CONSOLE_RX,
+    LED1 = PB_5,
+
+    NC = -1
+} PinName;
+
+typedef enum {
+    PullNone = 0,
+    PullUp = 1,
+    PullDown = 2,
+    PullDefault = PullNone
+} PinMode;
+
+#endif // MBED_HOST_PIN_NAMES_H
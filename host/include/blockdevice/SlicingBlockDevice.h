@@ -0,0 +1,47 @@
+// SlicingBlockDevice.h
+#ifndef MBED_HOST_SLICING_BLOCK_DEVICE_H
+#define MBED_HOST_SLICING_BLOCK_DEVICE_H
+
+#include "blockdevice/BlockDevice.h"
+
+namespace mbed {
+
+/**
+ * @class SlicingBlockDevice
+ * @brief Window onto a range of another block device.
+ */
+class SlicingBlockDevice: public BlockDevice {
+    public:
+        /**
+         * @param bd Underlying device, outliving the slice.
+         * @param start Start of the slice on bd.
+         * @param end End of the slice on bd, 0 for the end of bd.
+         */
+        SlicingBlockDevice(BlockDevice* bd, bd_addr_t start, bd_addr_t end = 0);
+
+        int init() override;
+        int deinit() override;
+        int sync() override;
+        int read(void* buffer, bd_addr_t addr, bd_size_t size) override;
+        int program(const void* buffer, bd_addr_t addr, bd_size_t size) override;
+        int erase(bd_addr_t addr, bd_size_t size) override;
+        int trim(bd_addr_t addr, bd_size_t size) override;
+        bd_size_t get_read_size() const override;
+        bd_size_t get_program_size() const override;
+        bd_size_t get_erase_size() const override;
+        bd_size_t get_erase_size(bd_addr_t addr) const override;
+        int get_erase_value() const override;
+        bd_size_t size() const override;
+        const char* get_type() const override;
+
+    private:
+        BlockDevice* m_bd;
+        bd_addr_t    m_start;
+        bd_addr_t    m_stop;    ///< End of the slice, resolved by init() if it is the end of bd.
+};
+
+} // namespace mbed
+
+using mbed::SlicingBlockDevice;
+
+#endif // MBED_HOST_SLICING_BLOCK_DEVICE_H
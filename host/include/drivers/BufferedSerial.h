@@ -0,0 +1,84 @@
+// BufferedSerial.h
+#ifndef MBED_HOST_BUFFERED_SERIAL_H
+#define MBED_HOST_BUFFERED_SERIAL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+#include "PinNames.h"
+#include "platform/NonCopyable.h"
+
+#ifndef MBED_CONF_PLATFORM_DEFAULT_SERIAL_BAUD_RATE
+#define MBED_CONF_PLATFORM_DEFAULT_SERIAL_BAUD_RATE 9600
+#endif
+
+namespace mbed {
+
+/**
+ * @class BufferedSerial
+ * @brief UART on the master side of a pseudo terminal.
+ *
+ * The slave device is printed when the port opens, and linked from the path in
+ * PHYTO_SERIAL_LINK if set, so the host tools open it as they would the board's
+ * port. Writes are paced at the baud rate with 10 bits per byte, so a slow link
+ * slows the sender as the UART does. Bytes written while the pty is full, e.g.
+ * before anything opened the slave, are dropped and counted, as a UART transmits
+ * whether or not anyone listens.
+ */
+class BufferedSerial: private NonCopyable<BufferedSerial> {
+    public:
+        enum Parity {
+            None = 0,
+            Odd,
+            Even,
+            Forced1,
+            Forced0
+        };
+
+        BufferedSerial(PinName tx, PinName rx, int baud = MBED_CONF_PLATFORM_DEFAULT_SERIAL_BAUD_RATE);
+
+        ~BufferedSerial();
+
+        void set_baud(int baud);
+
+        void set_format(int bits = 8, Parity parity = None, int stop_bits = 1);
+
+        /**
+         * @return Bytes written, all of them unless the port could not be opened.
+         */
+        ssize_t write(const void* buffer, std::size_t length);
+
+        /**
+         * @return Bytes read, -EAGAIN if none is available or input is disabled.
+         */
+        ssize_t read(void* buffer, std::size_t length);
+
+        int enable_input(bool enabled = true);
+
+        int enable_output(bool enabled = true);
+
+        bool readable() const;
+
+        bool writable() const;
+
+        /// Returns the path of the slave device, empty if the port could not be opened.
+        const char* get_device_name() const;
+
+        /// Returns the number of bytes dropped because the pty was full.
+        uint32_t get_dropped_count() const;
+
+    private:
+        int                     m_fd;
+        int                     m_baud;
+        int                     m_bits_per_byte;
+        bool                    m_input;
+        bool                    m_output;
+        char                    m_device_name[64];
+        std::atomic<uint32_t>   m_dropped;
+};
+
+} // namespace mbed
+
+#endif // MBED_HOST_BUFFERED_SERIAL_H
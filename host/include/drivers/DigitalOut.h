@@ -0,0 +1,45 @@
+// DigitalOut.h
+#ifndef MBED_HOST_DIGITAL_OUT_H
+#define MBED_HOST_DIGITAL_OUT_H
+
+#include "PinNames.h"
+
+namespace mbed {
+
+/**
+ * @class DigitalOut
+ * @brief Output pin. On the host it only remembers its level.
+ */
+class DigitalOut {
+    public:
+        explicit DigitalOut(PinName pin, int value = 0): m_pin(pin), m_value(value) {}
+
+        void write(int value) {
+            m_value = value != 0;
+        }
+
+        int read() const {
+            return m_value;
+        }
+
+        int is_connected() const {
+            return m_pin != NC;
+        }
+
+        DigitalOut& operator=(int value) {
+            write(value);
+            return *this;
+        }
+
+        operator int() const {
+            return read();
+        }
+
+    private:
+        PinName m_pin;
+        int     m_value;
+};
+
+} // namespace mbed
+
+#endif // MBED_HOST_DIGITAL_OUT_H
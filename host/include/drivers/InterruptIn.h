@@ -0,0 +1,57 @@
+// InterruptIn.h
+#ifndef MBED_HOST_INTERRUPT_IN_H
+#define MBED_HOST_INTERRUPT_IN_H
+
+#include "PinNames.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+namespace mbed {
+
+/**
+ * @class InterruptIn
+ * @brief Input pin with edge interrupts. On the host nothing drives the pin: it
+ * reads high and its edges never occur, so the board's converters simply never
+ * become ready. The simulation replaces them.
+ */
+class InterruptIn: private NonCopyable<InterruptIn> {
+    public:
+        explicit InterruptIn(PinName pin): m_pin(pin) {}
+
+        InterruptIn(PinName pin, PinMode mode): m_pin(pin) {
+            (void)mode;
+        }
+
+        int read() {
+            return 1;
+        }
+
+        operator int() {
+            return read();
+        }
+
+        void rise(Callback<void()> func) {
+            m_rise = func;
+        }
+
+        void fall(Callback<void()> func) {
+            m_fall = func;
+        }
+
+        void mode(PinMode pull) {
+            (void)pull;
+        }
+
+        void enable_irq() {}
+
+        void disable_irq() {}
+
+    private:
+        PinName          m_pin;
+        Callback<void()> m_rise;
+        Callback<void()> m_fall;
+};
+
+} // namespace mbed
+
+#endif // MBED_HOST_INTERRUPT_IN_H
@@ -0,0 +1,56 @@
+// SPI.h
+#ifndef MBED_HOST_SPI_H
+#define MBED_HOST_SPI_H
+
+#include <cstring>
+
+#include "PinNames.h"
+#include "platform/NonCopyable.h"
+
+// DEVICE_SPI_ASYNCH stays undefined: the host has no DMA and buses transfer synchronously.
+
+namespace mbed {
+
+/**
+ * @class SPI
+ * @brief SPI master with nothing connected: MISO floats high, every byte reads 0xFF.
+ */
+class SPI: private NonCopyable<SPI> {
+    public:
+        SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel = NC) {
+            (void)mosi;
+            (void)miso;
+            (void)sclk;
+            (void)ssel;
+        }
+
+        void format(int bits, int mode = 0) {
+            (void)bits;
+            (void)mode;
+        }
+
+        void frequency(int hz = 1000000) {
+            (void)hz;
+        }
+
+        int write(int value) {
+            (void)value;
+            return 0xFF;
+        }
+
+        int write(const char* tx_buffer, int tx_length, char* rx_buffer, int rx_length) {
+            (void)tx_buffer;
+            if (rx_buffer != nullptr && rx_length > 0) {
+                std::memset(rx_buffer, 0xFF, rx_length);
+            }
+            return tx_length > rx_length ? tx_length : rx_length;
+        }
+
+        void lock() {}
+
+        void unlock() {}
+};
+
+} // namespace mbed
+
+#endif // MBED_HOST_SPI_H
@@ -0,0 +1,44 @@
+// Timeout.h
+#ifndef MBED_HOST_TIMEOUT_H
+#define MBED_HOST_TIMEOUT_H
+
+#include <chrono>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+namespace mbed {
+
+/**
+ * @class Timeout
+ * @brief Calls a function once after a delay, in interrupt context.
+ *
+ * The handlers of all Timeouts run on one interrupt thread, inside a critical
+ * section, so they are serialised with each other and with CriticalSectionLock
+ * as interrupts are on the target. Once detach() returns the handler does not run.
+ */
+class Timeout: private NonCopyable<Timeout> {
+    public:
+        Timeout();
+
+        ~Timeout();
+
+        /**
+         * @brief Calls func after t, replacing a pending call.
+         */
+        void attach(Callback<void()> func, std::chrono::microseconds t);
+
+        /**
+         * @brief Cancels the pending call.
+         */
+        void detach();
+
+    private:
+        friend class InterruptThread;
+
+        Callback<void()>    m_handler;
+};
+
+} // namespace mbed
+
+#endif // MBED_HOST_TIMEOUT_H
@@ -0,0 +1,69 @@
+// Timer.h
+#ifndef MBED_HOST_TIMER_H
+#define MBED_HOST_TIMER_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace mbed {
+
+/**
+ * @class Timer
+ * @brief Stopwatch with microsecond resolution, on the steady clock.
+ */
+class Timer {
+    public:
+        Timer(): m_running(false), m_elapsed(0) {}
+
+        void start() {
+            if (!m_running) {
+                m_start = std::chrono::steady_clock::now();
+                m_running = true;
+            }
+        }
+
+        void stop() {
+            if (m_running) {
+                m_elapsed += running_time();
+                m_running = false;
+            }
+        }
+
+        void reset() {
+            m_elapsed = std::chrono::microseconds(0);
+            m_start = std::chrono::steady_clock::now();
+        }
+
+        std::chrono::microseconds elapsed_time() const {
+            return m_running ? m_elapsed + running_time() : m_elapsed;
+        }
+
+        int read_us() const {
+            return static_cast<int>(elapsed_time().count());
+        }
+
+        int read_ms() const {
+            return static_cast<int>(elapsed_time().count() / 1000);
+        }
+
+        float read() const {
+            return elapsed_time().count() / 1000000.0f;
+        }
+
+    private:
+        bool                                    m_running;
+        std::chrono::microseconds               m_elapsed;
+        std::chrono::steady_clock::time_point   m_start;
+
+        std::chrono::microseconds running_time() const {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start);
+        }
+};
+
+/// Timer on the low power ticker of the target. Both are the steady clock on the host.
+class LowPowerTimer: public Timer {
+};
+
+} // namespace mbed
+
+#endif // MBED_HOST_TIMER_H
@@ -0,0 +1,137 @@
+// EventQueue.h
+#ifndef MBED_HOST_EVENT_QUEUE_H
+#define MBED_HOST_EVENT_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <utility>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+#include "rtos/Kernel.h"
+
+/// Bytes of queue memory per event, so EventQueue(n * EVENTS_EVENT_SIZE) holds n events as on the target.
+#define EVENTS_EVENT_SIZE 64
+
+/// Default queue size, 32 events.
+#define EVENTS_QUEUE_SIZE (32 * EVENTS_EVENT_SIZE)
+
+namespace events {
+
+/**
+ * @class EventQueue
+ * @brief Queue of events dispatched in order by the thread that calls dispatch.
+ *
+ * Like Mbed's, it holds a fixed number of pending events, size / EVENTS_EVENT_SIZE,
+ * and call() returns 0 once they are all taken, so a queue that overflows on the
+ * target overflows on the host. Events may be posted from interrupt handlers.
+ */
+class EventQueue: private mbed::NonCopyable<EventQueue> {
+    public:
+        using duration = std::chrono::duration<int, std::milli>;
+
+        explicit EventQueue(unsigned size = EVENTS_QUEUE_SIZE, unsigned char* buffer = nullptr);
+
+        /**
+         * @brief Posts f(args...) to run as soon as possible.
+         * @return Identifier of the event, 0 if the queue is full.
+         */
+        template <typename F, typename... ArgTs>
+        int call(F f, ArgTs... args) {
+            return post(duration(0), duration(-1), bind(std::move(f), std::move(args)...));
+        }
+
+        template <typename T, typename R, typename... ArgTs>
+        int call(T* obj, R (T::*method)(ArgTs...), ArgTs... args) {
+            return call(mbed::callback(obj, method), std::move(args)...);
+        }
+
+        /**
+         * @brief Posts f(args...) to run after a delay.
+         * @return Identifier of the event, 0 if the queue is full.
+         */
+        template <typename F, typename... ArgTs>
+        int call_in(duration ms, F f, ArgTs... args) {
+            return post(ms, duration(-1), bind(std::move(f), std::move(args)...));
+        }
+
+        /**
+         * @brief Posts f(args...) to run periodically, first after one period.
+         * @return Identifier of the event, 0 if the queue is full.
+         */
+        template <typename F, typename... ArgTs>
+        int call_every(duration ms, F f, ArgTs... args) {
+            return post(ms, ms, bind(std::move(f), std::move(args)...));
+        }
+
+        /**
+         * @brief Cancels a pending or periodic event.
+         * @return True if the event was cancelled before it ran.
+         */
+        bool cancel(int id);
+
+        /**
+         * @brief Runs events until break_dispatch() is called.
+         */
+        void dispatch_forever();
+
+        /**
+         * @brief Runs the events that are due and returns.
+         */
+        void dispatch_once();
+
+        /**
+         * @brief Runs events for a time.
+         */
+        void dispatch_for(duration ms);
+
+        /**
+         * @brief Makes the running dispatch return after its current event.
+         */
+        void break_dispatch();
+
+        /**
+         * @brief Returns the number of events that may be pending at once.
+         */
+        unsigned get_capacity() const {
+            return m_capacity;
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        struct Event {
+            int                     id;
+            clock::time_point       due;
+            duration                period;     ///< Negative for a single shot.
+            std::function<void()>   function;
+        };
+
+        mutable std::mutex      m_mutex;
+        std::condition_variable m_changed;
+        std::list<Event>        m_events;   ///< Pending events, by due time then order of posting.
+        unsigned                m_capacity;
+        int                     m_running_id;           ///< Event being dispatched, 0 if none.
+        bool                    m_running_cancelled;    ///< The running periodic event was cancelled.
+        int                     m_next_id;
+        bool                    m_break;
+
+        template <typename F, typename... ArgTs>
+        static std::function<void()> bind(F f, ArgTs... args) {
+            return [f, args...]() mutable { f(args...); };
+        }
+
+        int post(duration delay, duration period, std::function<void()> function);
+
+        void insert(Event event);
+
+        void dispatch(bool forever, clock::time_point until);
+};
+
+} // namespace events
+
+#endif // MBED_HOST_EVENT_QUEUE_H
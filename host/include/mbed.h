@@ -0,0 +1,57 @@
+// mbed.h
+#ifndef MBED_HOST_MBED_H
+#define MBED_HOST_MBED_H
+
+/*
+ * Linux implementation of the subset of Mbed OS 6 the firmware uses, so the
+ * unmodified pipeline runs as a host process. Threads are std::threads, the RTOS
+ * primitives are built on std::mutex and condition variables, interrupts are
+ * timer callbacks run under one global lock and the serial port is a pty.
+ *
+ * Priorities only lower the nice value of a thread and stack sizes are ignored:
+ * host threads get the default stack, which the firmware's printf-heavy paths need.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "platform/mbed_toolchain.h"
+#include "platform/NonCopyable.h"
+#include "platform/Callback.h"
+#include "platform/CriticalSectionLock.h"
+#include "platform/mbed_stats.h"
+#include "platform/mbed_thread.h"
+#include "PinNames.h"
+
+#include "rtos/Kernel.h"
+#include "rtos/ThisThread.h"
+#include "rtos/Thread.h"
+#include "rtos/Mutex.h"
+#include "rtos/ConditionVariable.h"
+#include "rtos/Semaphore.h"
+#include "rtos/EventFlags.h"
+#include "rtos/MemoryPool.h"
+
+#include "events/EventQueue.h"
+
+#include "drivers/DigitalOut.h"
+#include "drivers/InterruptIn.h"
+#include "drivers/SPI.h"
+#include "drivers/Timer.h"
+#include "drivers/Timeout.h"
+#include "drivers/BufferedSerial.h"
+
+// Frequency of the core the firmware runs on, for cycle counts
+extern uint32_t SystemCoreClock;
+
+#ifndef MBED_NO_GLOBAL_USING_DIRECTIVE
+using namespace mbed;
+using namespace rtos;
+using namespace events;
+using namespace std;
+#endif
+
+#endif // MBED_HOST_MBED_H
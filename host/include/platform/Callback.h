@@ -0,0 +1,96 @@
+// Callback.h
+#ifndef MBED_HOST_CALLBACK_H
+#define MBED_HOST_CALLBACK_H
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace mbed {
+
+template <typename Signature>
+class Callback;
+
+/**
+ * @class Callback
+ * @brief Function, member function or functor with a fixed signature, on std::function.
+ *
+ * Unlike Mbed's, it may allocate when a functor is larger than the small buffer of
+ * std::function. An empty callback tests false and must not be called.
+ */
+template <typename R, typename... ArgTs>
+class Callback<R(ArgTs...)> {
+    public:
+        Callback() = default;
+
+        Callback(std::nullptr_t) {}
+
+        Callback(R (*func)(ArgTs...)) {
+            if (func) {
+                m_func = func;
+            }
+        }
+
+        template <typename T, typename U>
+        Callback(U* obj, R (T::*method)(ArgTs...)):
+            m_func([obj, method](ArgTs... args) -> R { return (obj->*method)(std::forward<ArgTs>(args)...); }) {}
+
+        template <typename T, typename U>
+        Callback(const U* obj, R (T::*method)(ArgTs...) const):
+            m_func([obj, method](ArgTs... args) -> R { return (obj->*method)(std::forward<ArgTs>(args)...); }) {}
+
+        template <typename F,
+                  typename = typename std::enable_if<
+                      !std::is_same<typename std::decay<F>::type, Callback>::value &&
+                      !std::is_pointer<typename std::decay<F>::type>::value &&
+                      std::is_invocable_r<R, F&, ArgTs...>::value>::type>
+        Callback(F func): m_func(std::move(func)) {}
+
+        R operator()(ArgTs... args) const {
+            return m_func(std::forward<ArgTs>(args)...);
+        }
+
+        R call(ArgTs... args) const {
+            return m_func(std::forward<ArgTs>(args)...);
+        }
+
+        explicit operator bool() const {
+            return static_cast<bool>(m_func);
+        }
+
+        friend bool operator==(const Callback& callback, std::nullptr_t) {
+            return !callback;
+        }
+
+        friend bool operator!=(const Callback& callback, std::nullptr_t) {
+            return static_cast<bool>(callback);
+        }
+
+    private:
+        std::function<R(ArgTs...)> m_func;
+};
+
+template <typename R, typename... ArgTs>
+Callback<R(ArgTs...)> callback(R (*func)(ArgTs...)) {
+    return Callback<R(ArgTs...)>(func);
+}
+
+template <typename R, typename... ArgTs>
+Callback<R(ArgTs...)> callback(const Callback<R(ArgTs...)>& func) {
+    return func;
+}
+
+template <typename T, typename U, typename R, typename... ArgTs>
+Callback<R(ArgTs...)> callback(U* obj, R (T::*method)(ArgTs...)) {
+    return Callback<R(ArgTs...)>(obj, method);
+}
+
+template <typename T, typename U, typename R, typename... ArgTs>
+Callback<R(ArgTs...)> callback(const U* obj, R (T::*method)(ArgTs...) const) {
+    return Callback<R(ArgTs...)>(obj, method);
+}
+
+} // namespace mbed
+
+#endif // MBED_HOST_CALLBACK_H
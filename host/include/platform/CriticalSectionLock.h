@@ -0,0 +1,39 @@
+// CriticalSectionLock.h
+#ifndef MBED_HOST_CRITICAL_SECTION_LOCK_H
+#define MBED_HOST_CRITICAL_SECTION_LOCK_H
+
+#include "platform/NonCopyable.h"
+
+namespace mbed {
+
+/**
+ * @class CriticalSectionLock
+ * @brief Masks the simulated interrupts for its scope.
+ *
+ * Interrupt handlers (Timeout callbacks) run holding the same recursive lock, so a
+ * critical section excludes them and every other critical section, as on a single
+ * core with interrupts disabled. It nests, and handlers may take it again.
+ */
+class CriticalSectionLock: private NonCopyable<CriticalSectionLock> {
+    public:
+        CriticalSectionLock() {
+            enable();
+        }
+
+        ~CriticalSectionLock() {
+            disable();
+        }
+
+        /// Enters a critical section.
+        static void enable(void);
+
+        /// Leaves a critical section.
+        static void disable(void);
+};
+
+} // namespace mbed
+
+/// Returns true on the thread running the simulated interrupt handlers.
+bool core_util_is_isr_active(void);
+
+#endif // MBED_HOST_CRITICAL_SECTION_LOCK_H
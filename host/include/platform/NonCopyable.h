@@ -0,0 +1,21 @@
+// NonCopyable.h
+#ifndef MBED_HOST_NON_COPYABLE_H
+#define MBED_HOST_NON_COPYABLE_H
+
+namespace mbed {
+
+/// Base of the classes that must not be copied, as in Mbed OS.
+template <typename T>
+class NonCopyable {
+    public:
+        NonCopyable(const NonCopyable&) = delete;
+        NonCopyable& operator=(const NonCopyable&) = delete;
+
+    protected:
+        NonCopyable() = default;
+        ~NonCopyable() = default;
+};
+
+} // namespace mbed
+
+#endif // MBED_HOST_NON_COPYABLE_H
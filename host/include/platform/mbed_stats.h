@@ -0,0 +1,47 @@
+// mbed_stats.h
+#ifndef MBED_HOST_STATS_H
+#define MBED_HOST_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Statistics in Mbed's layout. Heap figures come from mallinfo2(), stack figures
+ * from the shim's thread registry (reserved sizes as requested, unused on the
+ * host, and no high water mark) and CPU figures from the process CPU time: idle
+ * is the wall time not spent running any thread, as seen by a single core.
+ *
+ * The 32-bit fields are unsigned long, which uint32_t is on the target, so the
+ * firmware's %ld formats fit on the host too.
+ */
+
+typedef struct {
+    unsigned long current_size;      ///< Bytes allocated currently.
+    unsigned long max_size;          ///< Max bytes allocated at a given time.
+    unsigned long total_size;        ///< Cumulative sum of bytes ever allocated.
+    unsigned long reserved_size;     ///< Current number of bytes allocated for the heap.
+    unsigned long alloc_cnt;         ///< Current number of allocations.
+    unsigned long alloc_fail_cnt;    ///< Number of failed allocations.
+    unsigned long overhead_size;     ///< Overhead added to heap for stats.
+} mbed_stats_heap_t;
+
+typedef struct {
+    unsigned long thread_id;         ///< Identifier of the thread that owns the stack, 0 if multiple threads.
+    unsigned long max_size;          ///< Maximum number of bytes used on the stack.
+    unsigned long reserved_size;     ///< Current number of bytes allocated for the stack.
+    unsigned long stack_cnt;         ///< Number of stacks stats accumulated in the structure.
+} mbed_stats_stack_t;
+
+typedef struct {
+    uint64_t uptime;            ///< Time since the process started, in microseconds.
+    uint64_t idle_time;         ///< Time spent in the idle thread since the process started.
+    uint64_t sleep_time;        ///< Time spent in sleep since the process started.
+    uint64_t deep_sleep_time;   ///< Time spent in deep sleep since the process started.
+} mbed_stats_cpu_t;
+
+void mbed_stats_heap_get(mbed_stats_heap_t* stats);
+void mbed_stats_stack_get(mbed_stats_stack_t* stats);
+std::size_t mbed_stats_stack_get_each(mbed_stats_stack_t* stats, std::size_t count);
+void mbed_stats_cpu_get(mbed_stats_cpu_t* stats);
+
+#endif // MBED_HOST_STATS_H
@@ -0,0 +1,10 @@
+// mbed_thread.h
+#ifndef MBED_HOST_THREAD_FUNCTIONS_H
+#define MBED_HOST_THREAD_FUNCTIONS_H
+
+#include <cstdint>
+
+/// Sleeps the calling thread.
+void thread_sleep_for(uint32_t millisec);
+
+#endif // MBED_HOST_THREAD_FUNCTIONS_H
@@ -0,0 +1,27 @@
+// mbed_toolchain.h
+#ifndef MBED_HOST_TOOLCHAIN_H
+#define MBED_HOST_TOOLCHAIN_H
+
+#include <cstdio>
+#include <cstdlib>
+
+#define MBED_UNUSED __attribute__((__unused__))
+#define MBED_USED __attribute__((used))
+#define MBED_WEAK __attribute__((weak))
+#define MBED_PACKED(struct) struct __attribute__((packed))
+#define MBED_ALIGN(N) __attribute__((aligned(N)))
+#define MBED_FORCEINLINE inline __attribute__((always_inline))
+#define MBED_NORETURN __attribute__((noreturn))
+
+/// Aborts with the failed expression, as the firmware halts in mbed_assert_internal().
+#define MBED_ASSERT(expr)                                                                   \
+    do {                                                                                    \
+        if (!(expr)) {                                                                      \
+            std::fprintf(stderr, "MBED_ASSERT failed: %s, %s:%d\n", #expr, __FILE__, __LINE__); \
+            std::abort();                                                                   \
+        }                                                                                   \
+    } while (0)
+
+#define MBED_STATIC_ASSERT(expr, msg) static_assert(expr, msg)
+
+#endif // MBED_HOST_TOOLCHAIN_H
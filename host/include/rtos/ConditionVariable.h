@@ -0,0 +1,57 @@
+// ConditionVariable.h
+#ifndef MBED_HOST_CONDITION_VARIABLE_H
+#define MBED_HOST_CONDITION_VARIABLE_H
+
+#include <chrono>
+#include <condition_variable>
+
+#include "platform/NonCopyable.h"
+#include "platform/mbed_toolchain.h"
+#include "rtos/Kernel.h"
+#include "rtos/Mutex.h"
+
+namespace rtos {
+
+/**
+ * @class ConditionVariable
+ * @brief Condition variable bound to a Mutex, which must be locked exactly once by the waiter.
+ *
+ * As on the target, the notifying thread must own the mutex.
+ */
+class ConditionVariable: private mbed::NonCopyable<ConditionVariable> {
+    public:
+        explicit ConditionVariable(Mutex& mutex): m_mutex(mutex) {}
+
+        void wait() {
+            m_condition.wait(m_mutex);
+        }
+
+        /**
+         * @return True if the wait timed out.
+         */
+        bool wait_for(Kernel::Clock::duration_u32 rel_time) {
+            if (rel_time == Kernel::wait_for_u32_forever) {
+                wait();
+                return false;
+            }
+            return m_condition.wait_for(m_mutex, std::chrono::milliseconds(rel_time.count())) == std::cv_status::timeout;
+        }
+
+        void notify_one() {
+            MBED_ASSERT(m_mutex.get_owner() == ThisThread::get_id());
+            m_condition.notify_one();
+        }
+
+        void notify_all() {
+            MBED_ASSERT(m_mutex.get_owner() == ThisThread::get_id());
+            m_condition.notify_all();
+        }
+
+    private:
+        Mutex&                      m_mutex;
+        std::condition_variable_any m_condition;
+};
+
+} // namespace rtos
+
+#endif // MBED_HOST_CONDITION_VARIABLE_H
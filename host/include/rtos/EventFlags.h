@@ -0,0 +1,92 @@
+// EventFlags.h
+#ifndef MBED_HOST_EVENT_FLAGS_H
+#define MBED_HOST_EVENT_FLAGS_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "platform/NonCopyable.h"
+#include "rtos/Kernel.h"
+
+namespace rtos {
+
+/**
+ * @class EventFlags
+ * @brief 31 event flags threads wait on. Set may be called from interrupt handlers.
+ */
+class EventFlags: private mbed::NonCopyable<EventFlags> {
+    public:
+        EventFlags(): m_flags(0) {}
+
+        explicit EventFlags(const char* name): m_flags(0) {
+            (void)name;
+        }
+
+        /// @return The flags after setting.
+        uint32_t set(uint32_t flags) {
+            uint32_t result;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_flags |= flags & 0x7FFFFFFF;
+                result = m_flags;
+            }
+            m_changed.notify_all();
+            return result;
+        }
+
+        /// @return The flags before clearing.
+        uint32_t clear(uint32_t flags = 0x7FFFFFFF) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const uint32_t result = m_flags;
+            m_flags &= ~flags;
+            return result;
+        }
+
+        uint32_t get() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_flags;
+        }
+
+        /// @return The flags when one of flags was set, osFlagsErrorTimeout on timeout.
+        uint32_t wait_any(uint32_t flags = 0, uint32_t millisec = osWaitForever, bool clear = true) {
+            return wait_any_for(flags, Kernel::Clock::duration_u32(millisec), clear);
+        }
+
+        uint32_t wait_any_for(uint32_t flags, Kernel::Clock::duration_u32 rel_time, bool clear = true) {
+            return wait(flags, rel_time, clear, false);
+        }
+
+        /// @return The flags when all of flags were set, osFlagsErrorTimeout on timeout.
+        uint32_t wait_all(uint32_t flags = 0, uint32_t millisec = osWaitForever, bool clear = true) {
+            return wait_all_for(flags, Kernel::Clock::duration_u32(millisec), clear);
+        }
+
+        uint32_t wait_all_for(uint32_t flags, Kernel::Clock::duration_u32 rel_time, bool clear = true) {
+            return wait(flags, rel_time, clear, true);
+        }
+
+    private:
+        mutable std::mutex      m_mutex;
+        std::condition_variable m_changed;
+        uint32_t                m_flags;
+
+        uint32_t wait(uint32_t flags, Kernel::Clock::duration_u32 rel_time, bool clear, bool all) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto satisfied = [this, flags, all] {
+                return all ? (m_flags & flags) == flags : (m_flags & flags) != 0;
+            };
+            if (!impl::wait_for(m_changed, lock, rel_time, satisfied)) {
+                return osFlagsErrorTimeout;
+            }
+            const uint32_t result = m_flags;
+            if (clear) {
+                m_flags &= ~flags;
+            }
+            return result;
+        }
+};
+
+} // namespace rtos
+
+#endif // MBED_HOST_EVENT_FLAGS_H
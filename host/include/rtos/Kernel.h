@@ -0,0 +1,58 @@
+// Kernel.h
+#ifndef MBED_HOST_KERNEL_H
+#define MBED_HOST_KERNEL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ratio>
+
+#include "rtos/mbed_rtos_types.h"
+
+namespace rtos {
+namespace Kernel {
+
+/**
+ * @brief RTOS clock with a millisecond tick, counting from the start of the process.
+ */
+struct Clock {
+    Clock() = delete;
+
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<Clock>;
+    /// Timeouts of the RTOS API, max() waits forever.
+    using duration_u32 = std::chrono::duration<uint32_t, period>;
+    static constexpr bool is_steady = true;
+
+    static time_point now();
+};
+
+/// Timeout that waits forever.
+inline constexpr Clock::duration_u32 wait_for_u32_forever = Clock::duration_u32::max();
+
+/// Returns the milliseconds since the start of the process.
+uint64_t get_ms_count();
+
+} // namespace Kernel
+
+namespace impl {
+
+/**
+ * @brief Waits on a condition variable until pred holds, or the RTOS timeout elapses.
+ * @return The value of pred.
+ */
+template <typename ConditionVariable, typename Lock, typename Predicate>
+bool wait_for(ConditionVariable& condition, Lock& lock, Kernel::Clock::duration_u32 timeout, Predicate pred) {
+    if (timeout == Kernel::wait_for_u32_forever) {
+        condition.wait(lock, pred);
+        return true;
+    }
+    return condition.wait_for(lock, std::chrono::milliseconds(timeout.count()), pred);
+}
+
+} // namespace impl
+} // namespace rtos
+
+#endif // MBED_HOST_KERNEL_H
@@ -0,0 +1,88 @@
+// MemoryPool.h
+#ifndef MBED_HOST_MEMORY_POOL_H
+#define MBED_HOST_MEMORY_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#include "platform/NonCopyable.h"
+#include "rtos/Kernel.h"
+
+namespace rtos {
+
+/**
+ * @class MemoryPool
+ * @brief Fixed number of uninitialised blocks for objects of type T. Free may be called
+ * from interrupt handlers.
+ */
+template <typename T, uint32_t pool_sz>
+class MemoryPool: private mbed::NonCopyable<MemoryPool<T, pool_sz>> {
+    static_assert(pool_sz > 0, "Invalid memory pool size. Must be greater than 0.");
+
+    public:
+        MemoryPool(): m_free_count(pool_sz) {
+            for (uint32_t i = 0; i < pool_sz; i++) {
+                m_free[i] = i;
+            }
+        }
+
+        T* try_alloc() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return take();
+        }
+
+        T* try_alloc_for(Kernel::Clock::duration_u32 rel_time) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!impl::wait_for(m_freed, lock, rel_time, [this] { return m_free_count > 0; })) {
+                return nullptr;
+            }
+            return take();
+        }
+
+        T* try_calloc() {
+            T* block = try_alloc();
+            if (block != nullptr) {
+                std::memset(static_cast<void*>(block), 0, sizeof(T));
+            }
+            return block;
+        }
+
+        osStatus free(T* block) {
+            const uint32_t index = static_cast<uint32_t>(
+                (reinterpret_cast<unsigned char*>(block) - m_blocks[0].storage) / sizeof(Block));
+            if (block == nullptr || index >= pool_sz) {
+                return osErrorParameter;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_free[m_free_count++] = index;
+            }
+            m_freed.notify_one();
+            return osOK;
+        }
+
+    private:
+        struct Block {
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        std::mutex              m_mutex;
+        std::condition_variable m_freed;
+        Block                   m_blocks[pool_sz];
+        uint32_t                m_free[pool_sz];
+        uint32_t                m_free_count;
+
+        T* take() {
+            if (m_free_count == 0) {
+                return nullptr;
+            }
+            return reinterpret_cast<T*>(m_blocks[m_free[--m_free_count]].storage);
+        }
+};
+
+} // namespace rtos
+
+#endif // MBED_HOST_MEMORY_POOL_H
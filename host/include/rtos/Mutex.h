@@ -0,0 +1,79 @@
+// Mutex.h
+#ifndef MBED_HOST_MUTEX_H
+#define MBED_HOST_MUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "platform/NonCopyable.h"
+#include "rtos/Kernel.h"
+#include "rtos/ThisThread.h"
+
+namespace rtos {
+
+/**
+ * @class Mutex
+ * @brief Recursive mutex, as Mbed's, on std::recursive_timed_mutex.
+ */
+class Mutex: private mbed::NonCopyable<Mutex> {
+    public:
+        Mutex() = default;
+
+        explicit Mutex(const char* name) {
+            (void)name;
+        }
+
+        void lock() {
+            m_mutex.lock();
+            acquired();
+        }
+
+        bool trylock() {
+            if (!m_mutex.try_lock()) {
+                return false;
+            }
+            acquired();
+            return true;
+        }
+
+        bool trylock_for(Kernel::Clock::duration_u32 rel_time) {
+            if (rel_time == Kernel::wait_for_u32_forever) {
+                lock();
+                return true;
+            }
+            if (!m_mutex.try_lock_for(std::chrono::milliseconds(rel_time.count()))) {
+                return false;
+            }
+            acquired();
+            return true;
+        }
+
+        void unlock() {
+            if (--m_count == 0) {
+                m_owner = nullptr;
+            }
+            m_mutex.unlock();
+        }
+
+        /**
+         * @brief Returns the thread holding the mutex, nullptr if it is free.
+         */
+        osThreadId_t get_owner() {
+            return m_owner;
+        }
+
+    private:
+        std::recursive_timed_mutex m_mutex;
+        std::atomic<osThreadId_t>  m_owner{nullptr};
+        unsigned int               m_count = 0;     ///< Nesting depth, only touched by the owner.
+
+        void acquired() {
+            m_owner = ThisThread::get_id();
+            m_count++;
+        }
+};
+
+} // namespace rtos
+
+#endif // MBED_HOST_MUTEX_H
@@ -0,0 +1,71 @@
+// Semaphore.h
+#ifndef MBED_HOST_SEMAPHORE_H
+#define MBED_HOST_SEMAPHORE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "platform/NonCopyable.h"
+#include "rtos/Kernel.h"
+
+namespace rtos {
+
+/**
+ * @class Semaphore
+ * @brief Counting semaphore. Release may be called from interrupt handlers.
+ */
+class Semaphore: private mbed::NonCopyable<Semaphore> {
+    public:
+        explicit Semaphore(int32_t count = 0, uint16_t max_count = 0xFFFF):
+            m_count(count), m_max_count(max_count) {}
+
+        void acquire() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_available.wait(lock, [this] { return m_count > 0; });
+            m_count--;
+        }
+
+        bool try_acquire() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_count == 0) {
+                return false;
+            }
+            m_count--;
+            return true;
+        }
+
+        bool try_acquire_for(Kernel::Clock::duration_u32 rel_time) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!impl::wait_for(m_available, lock, rel_time, [this] { return m_count > 0; })) {
+                return false;
+            }
+            m_count--;
+            return true;
+        }
+
+        /**
+         * @return osOK, or osErrorResource if the count is at its maximum.
+         */
+        osStatus release() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_count >= m_max_count) {
+                    return osErrorResource;
+                }
+                m_count++;
+            }
+            m_available.notify_one();
+            return osOK;
+        }
+
+    private:
+        std::mutex              m_mutex;
+        std::condition_variable m_available;
+        int32_t                 m_count;
+        int32_t                 m_max_count;
+};
+
+} // namespace rtos
+
+#endif // MBED_HOST_SEMAPHORE_H
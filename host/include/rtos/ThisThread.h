@@ -0,0 +1,28 @@
+// ThisThread.h
+#ifndef MBED_HOST_THIS_THREAD_H
+#define MBED_HOST_THIS_THREAD_H
+
+#include "rtos/Kernel.h"
+
+namespace rtos {
+namespace ThisThread {
+
+/// Sleeps the calling thread.
+void sleep_for(Kernel::Clock::duration_u32 rel_time);
+
+/// Sleeps the calling thread until an absolute time.
+void sleep_until(Kernel::Clock::time_point abs_time);
+
+/// Passes control to the next ready thread.
+void yield();
+
+/// Returns the identifier of the calling thread.
+osThreadId_t get_id();
+
+/// Returns the name of the calling thread, "main" for the main thread.
+const char* get_name();
+
+} // namespace ThisThread
+} // namespace rtos
+
+#endif // MBED_HOST_THIS_THREAD_H
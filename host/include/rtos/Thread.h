@@ -0,0 +1,70 @@
+// Thread.h
+#ifndef MBED_HOST_THREAD_H
+#define MBED_HOST_THREAD_H
+
+#include <cstdint>
+#include <thread>
+
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+#include "rtos/mbed_rtos_types.h"
+
+namespace rtos {
+
+/**
+ * @class Thread
+ * @brief RTOS thread on a std::thread.
+ *
+ * The stack size and memory are recorded for the statistics but not used: host
+ * threads get the default stack. A priority below normal raises the nice value
+ * of the thread, higher priorities would need privileges and are not applied.
+ * The name shows in top, perf and gdb. A thread that is still running when its
+ * Thread is destroyed is detached, so firmware threads looping forever do not
+ * stop the process from exiting.
+ */
+class Thread: private mbed::NonCopyable<Thread> {
+    public:
+        Thread(osPriority priority = osPriorityNormal, uint32_t stack_size = OS_STACK_SIZE,
+               unsigned char* stack_mem = nullptr, const char* name = nullptr);
+
+        ~Thread();
+
+        /**
+         * @brief Starts the thread running task.
+         * @return osOK, or osErrorResource if the thread was started before.
+         */
+        osStatus start(mbed::Callback<void()> task);
+
+        /**
+         * @brief Waits until the thread returns.
+         */
+        osStatus join();
+
+        /**
+         * @brief Changes the priority. Applied when the thread starts, or at once if
+         * called by the thread itself.
+         */
+        osStatus set_priority(osPriority priority);
+
+        osPriority get_priority() const;
+
+        uint32_t stack_size() const;
+
+        const char* get_name() const;
+
+        /// Returns the identifier of the thread, nullptr before it is started.
+        osThreadId_t get_id() const;
+
+    private:
+        friend struct ThreadRegistry;
+
+        osPriority      m_priority;
+        uint32_t        m_stack_size;
+        const char*     m_name;
+        std::thread     m_thread;
+        osThreadId_t    m_id;
+};
+
+} // namespace rtos
+
+#endif // MBED_HOST_THREAD_H
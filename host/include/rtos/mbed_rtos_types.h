@@ -0,0 +1,42 @@
+// mbed_rtos_types.h
+#ifndef MBED_HOST_RTOS_TYPES_H
+#define MBED_HOST_RTOS_TYPES_H
+
+#include <cstdint>
+
+// CMSIS-RTOS2 types and values the firmware uses
+
+typedef int32_t osStatus;
+
+#define osOK                0
+#define osError             -1
+#define osErrorTimeout      -2
+#define osErrorResource     -3
+#define osErrorParameter    -4
+
+#define osWaitForever       0xFFFFFFFFU
+#define osFlagsError        0x80000000U
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+
+/// Thread priorities. On the host, priorities below normal raise the nice value of the thread.
+typedef enum {
+    osPriorityNone          = 0,
+    osPriorityIdle          = 1,
+    osPriorityLow           = 8,
+    osPriorityBelowNormal   = 16,
+    osPriorityNormal        = 24,
+    osPriorityAboveNormal   = 32,
+    osPriorityHigh          = 40,
+    osPriorityRealtime      = 48,
+    osPriorityISR           = 56,
+    osPriorityError         = -1
+} osPriority;
+
+typedef void* osThreadId_t;
+
+#define OS_STACK_SIZE 4096
+
+/// Returns the number of threads, including main.
+uint32_t osThreadGetCount(void);
+
+#endif // MBED_HOST_RTOS_TYPES_H
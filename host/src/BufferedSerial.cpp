@@ -0,0 +1,131 @@
+#include "drivers/BufferedSerial.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+namespace mbed {
+
+BufferedSerial::BufferedSerial(PinName tx, PinName rx, int baud):
+    m_fd(-1), m_baud(baud), m_bits_per_byte(10), m_input(true), m_output(true), m_dropped(0){
+    (void)tx;
+    (void)rx;
+    m_device_name[0] = '\0';
+
+    // Non-blocking, so a full pty drops bytes instead of stalling the writer
+    m_fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (m_fd < 0 || grantpt(m_fd) != 0 || unlockpt(m_fd) != 0){
+        perror("BufferedSerial: cannot open a pty");
+        if (m_fd >= 0){
+            close(m_fd);
+            m_fd = -1;
+        }
+        return;
+    }
+    snprintf(m_device_name, sizeof(m_device_name), "%s", ptsname(m_fd));
+
+    // Raw line discipline, bytes pass unchanged as on a UART
+    struct termios settings;
+    if (tcgetattr(m_fd, &settings) == 0){
+        cfmakeraw(&settings);
+        tcsetattr(m_fd, TCSANOW, &settings);
+    }
+
+    const char* link = getenv("PHYTO_SERIAL_LINK");
+    if (link != nullptr){
+        unlink(link);
+        if (symlink(m_device_name, link) != 0){
+            perror("BufferedSerial: cannot link the pty");
+        }
+    }
+    fprintf(stderr, "Serial port at %d baud on %s%s%s\n", m_baud, m_device_name,
+            link != nullptr ? ", linked from " : "", link != nullptr ? link : "");
+}
+
+BufferedSerial::~BufferedSerial(){
+    if (m_fd >= 0){
+        close(m_fd);
+    }
+}
+
+void BufferedSerial::set_baud(int baud){
+    m_baud = baud;
+}
+
+void BufferedSerial::set_format(int bits, Parity parity, int stop_bits){
+    m_bits_per_byte = 1 + bits + (parity != None ? 1 : 0) + stop_bits;
+}
+
+/**
+ * The bytes that fit are written at once, then the writer sleeps for the time
+ * the UART would take to shift all of them out.
+ */
+ssize_t BufferedSerial::write(const void* buffer, std::size_t length){
+    if (m_fd < 0){
+        return -EBADF;
+    }
+    if (!m_output){
+        return static_cast<ssize_t>(length);
+    }
+
+    const ssize_t written = ::write(m_fd, buffer, length);
+    const std::size_t accepted = written > 0 ? static_cast<std::size_t>(written) : 0;
+    if (accepted < length){
+        m_dropped += static_cast<uint32_t>(length - accepted);
+    }
+
+    if (m_baud > 0){
+        std::this_thread::sleep_for(std::chrono::microseconds(
+            static_cast<int64_t>(length) * m_bits_per_byte * 1000000 / m_baud));
+    }
+    return static_cast<ssize_t>(length);
+}
+
+ssize_t BufferedSerial::read(void* buffer, std::size_t length){
+    if (m_fd < 0){
+        return -EBADF;
+    }
+    if (!m_input){
+        return -EAGAIN;
+    }
+    const ssize_t count = ::read(m_fd, buffer, length);
+    return count >= 0 ? count : -errno;
+}
+
+int BufferedSerial::enable_input(bool enabled){
+    m_input = enabled;
+    return 0;
+}
+
+int BufferedSerial::enable_output(bool enabled){
+    m_output = enabled;
+    return 0;
+}
+
+bool BufferedSerial::readable() const {
+    if (m_fd < 0 || !m_input){
+        return false;
+    }
+    struct pollfd descriptor = {m_fd, POLLIN, 0};
+    return poll(&descriptor, 1, 0) > 0 && (descriptor.revents & POLLIN) != 0;
+}
+
+bool BufferedSerial::writable() const {
+    return m_fd >= 0 && m_output;
+}
+
+const char* BufferedSerial::get_device_name() const {
+    return m_device_name;
+}
+
+uint32_t BufferedSerial::get_dropped_count() const {
+    return m_dropped;
+}
+
+} // namespace mbed
@@ -0,0 +1,37 @@
+#include "platform/CriticalSectionLock.h"
+
+#include <mutex>
+
+#include "mbed_host.h"
+
+namespace {
+
+// Never destroyed: detached threads may still enter critical sections while the process exits
+std::recursive_mutex& interrupt_lock(void){
+    static std::recursive_mutex* lock = new std::recursive_mutex;
+    return *lock;
+}
+
+thread_local bool isr_active = false;
+
+} // namespace
+
+namespace mbed {
+
+void CriticalSectionLock::enable(void){
+    interrupt_lock().lock();
+}
+
+void CriticalSectionLock::disable(void){
+    interrupt_lock().unlock();
+}
+
+} // namespace mbed
+
+bool core_util_is_isr_active(void){
+    return isr_active;
+}
+
+void mbed_host::set_isr_active(bool active){
+    isr_active = active;
+}
@@ -0,0 +1,123 @@
+#include "events/EventQueue.h"
+
+#include <climits>
+
+namespace events {
+
+EventQueue::EventQueue(unsigned size, unsigned char* buffer):
+    m_capacity(size / EVENTS_EVENT_SIZE > 0 ? size / EVENTS_EVENT_SIZE : 1),
+    m_running_id(0), m_running_cancelled(false), m_next_id(1), m_break(false){
+    (void)buffer;
+}
+
+/**
+ * As in equeue, an event holds its slot until it has run, so an event running
+ * counts against the capacity.
+ */
+int EventQueue::post(duration delay, duration period, std::function<void()> function){
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_events.size() + (m_running_id != 0 ? 1 : 0) >= m_capacity){
+            return 0;
+        }
+        id = m_next_id;
+        m_next_id = m_next_id == INT_MAX ? 1 : m_next_id + 1;
+        insert({id, clock::now() + delay, period, std::move(function)});
+    }
+    m_changed.notify_all();
+    return id;
+}
+
+void EventQueue::insert(Event event){
+    std::list<Event>::iterator position = m_events.begin();
+    while (position != m_events.end() && position->due <= event.due){
+        ++position;
+    }
+    m_events.insert(position, std::move(event));
+}
+
+bool EventQueue::cancel(int id){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::list<Event>::iterator event = m_events.begin(); event != m_events.end(); ++event){
+        if (event->id == id){
+            m_events.erase(event);
+            return true;
+        }
+    }
+    // A periodic event that is running is not queued again
+    if (id != 0 && id == m_running_id){
+        m_running_cancelled = true;
+    }
+    return false;
+}
+
+void EventQueue::dispatch_forever(){
+    dispatch(true, clock::time_point());
+}
+
+void EventQueue::dispatch_once(){
+    dispatch(false, clock::now());
+}
+
+void EventQueue::dispatch_for(duration ms){
+    dispatch(false, clock::now() + ms);
+}
+
+void EventQueue::break_dispatch(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_break = true;
+    }
+    m_changed.notify_all();
+}
+
+/**
+ * Events run without the lock held, so they may post, cancel and break. The
+ * dispatching thread sleeps on the condition variable until the first event is
+ * due, a new one is posted or the dispatch ends.
+ */
+void EventQueue::dispatch(bool forever, clock::time_point until){
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true){
+        if (m_break){
+            m_break = false;
+            return;
+        }
+
+        const clock::time_point now = clock::now();
+        if (!m_events.empty() && m_events.front().due <= now){
+            Event event = std::move(m_events.front());
+            m_events.pop_front();
+            m_running_id = event.id;
+            m_running_cancelled = false;
+
+            lock.unlock();
+            event.function();
+            lock.lock();
+
+            m_running_id = 0;
+            if (event.period.count() >= 0 && !m_running_cancelled){
+                event.due += event.period;
+                insert(std::move(event));
+            }
+            continue;
+        }
+
+        if (!forever && now >= until){
+            return;
+        }
+        if (m_events.empty()){
+            if (forever){
+                m_changed.wait(lock);
+            } else {
+                m_changed.wait_until(lock, until);
+            }
+        } else {
+            const clock::time_point due = m_events.front().due;
+            m_changed.wait_until(lock, forever || due < until ? due : until);
+        }
+    }
+}
+
+} // namespace events
@@ -0,0 +1,46 @@
+#include "FlashIAPBlockDevice.h"
+
+#include <cstdlib>
+
+namespace {
+
+const char* flash_file(void){
+    const char* path = getenv("PHYTO_FLASH_FILE");
+    return path != nullptr ? path : "flashiap.bin";
+}
+
+} // namespace
+
+FlashIAPBlockDevice::FlashIAPBlockDevice(uint32_t address, uint32_t size):
+    FileBlockDevice(flash_file(), size){
+    (void)address;
+}
+
+int FlashIAPBlockDevice::init(void){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FileBlockDevice::init();
+}
+
+int FlashIAPBlockDevice::deinit(void){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FileBlockDevice::deinit();
+}
+
+int FlashIAPBlockDevice::read(void* buffer, bd_addr_t address, bd_size_t size){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FileBlockDevice::read(buffer, address, size);
+}
+
+int FlashIAPBlockDevice::program(const void* buffer, bd_addr_t address, bd_size_t size){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FileBlockDevice::program(buffer, address, size);
+}
+
+int FlashIAPBlockDevice::erase(bd_addr_t address, bd_size_t size){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FileBlockDevice::erase(address, size);
+}
+
+const char* FlashIAPBlockDevice::get_type(void) const {
+    return "FLASHIAP";
+}
@@ -0,0 +1,54 @@
+#include "rtos/Kernel.h"
+#include "rtos/ThisThread.h"
+#include "platform/mbed_thread.h"
+
+#include <cstdint>
+#include <thread>
+
+#include "mbed_host.h"
+
+// The STM32WB55 core runs at 64 MHz, cycle counts of the firmware convert with it
+uint32_t SystemCoreClock = 64000000;
+
+std::chrono::steady_clock::time_point mbed_host::process_start(void){
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+namespace {
+
+// Taken during static initialisation at the latest, so the clocks start with the process
+const std::chrono::steady_clock::time_point start_time = mbed_host::process_start();
+
+} // namespace
+
+namespace rtos {
+
+Kernel::Clock::time_point Kernel::Clock::now(){
+    return time_point(std::chrono::duration_cast<duration>(std::chrono::steady_clock::now() - mbed_host::process_start()));
+}
+
+uint64_t Kernel::get_ms_count(){
+    return static_cast<uint64_t>(Clock::now().time_since_epoch().count());
+}
+
+void ThisThread::sleep_for(Kernel::Clock::duration_u32 rel_time){
+    std::this_thread::sleep_for(std::chrono::milliseconds(rel_time.count()));
+}
+
+void ThisThread::sleep_until(Kernel::Clock::time_point abs_time){
+    const Kernel::Clock::time_point now = Kernel::Clock::now();
+    if (abs_time > now){
+        std::this_thread::sleep_for(abs_time - now);
+    }
+}
+
+void ThisThread::yield(){
+    std::this_thread::yield();
+}
+
+} // namespace rtos
+
+void thread_sleep_for(uint32_t millisec){
+    std::this_thread::sleep_for(std::chrono::milliseconds(millisec));
+}
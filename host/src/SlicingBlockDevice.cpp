@@ -0,0 +1,87 @@
+#include "blockdevice/SlicingBlockDevice.h"
+
+namespace mbed {
+
+SlicingBlockDevice::SlicingBlockDevice(BlockDevice* bd, bd_addr_t start, bd_addr_t end):
+    m_bd(bd), m_start(start), m_stop(end){
+}
+
+int SlicingBlockDevice::init(){
+    const int err = m_bd->init();
+    if (err != 0){
+        return err;
+    }
+    if (m_stop == 0){
+        m_stop = m_bd->size();
+    }
+    if (m_start >= m_stop || m_stop > m_bd->size()){
+        return BD_ERROR_DEVICE_ERROR;
+    }
+    return 0;
+}
+
+int SlicingBlockDevice::deinit(){
+    return m_bd->deinit();
+}
+
+int SlicingBlockDevice::sync(){
+    return m_bd->sync();
+}
+
+int SlicingBlockDevice::read(void* buffer, bd_addr_t addr, bd_size_t size){
+    if (addr + size > this->size()){
+        return BD_ERROR_DEVICE_ERROR;
+    }
+    return m_bd->read(buffer, m_start + addr, size);
+}
+
+int SlicingBlockDevice::program(const void* buffer, bd_addr_t addr, bd_size_t size){
+    if (addr + size > this->size()){
+        return BD_ERROR_DEVICE_ERROR;
+    }
+    return m_bd->program(buffer, m_start + addr, size);
+}
+
+int SlicingBlockDevice::erase(bd_addr_t addr, bd_size_t size){
+    if (addr + size > this->size()){
+        return BD_ERROR_DEVICE_ERROR;
+    }
+    return m_bd->erase(m_start + addr, size);
+}
+
+int SlicingBlockDevice::trim(bd_addr_t addr, bd_size_t size){
+    if (addr + size > this->size()){
+        return BD_ERROR_DEVICE_ERROR;
+    }
+    return m_bd->trim(m_start + addr, size);
+}
+
+bd_size_t SlicingBlockDevice::get_read_size() const {
+    return m_bd->get_read_size();
+}
+
+bd_size_t SlicingBlockDevice::get_program_size() const {
+    return m_bd->get_program_size();
+}
+
+bd_size_t SlicingBlockDevice::get_erase_size() const {
+    return m_bd->get_erase_size(m_start);
+}
+
+bd_size_t SlicingBlockDevice::get_erase_size(bd_addr_t addr) const {
+    return m_bd->get_erase_size(m_start + addr);
+}
+
+int SlicingBlockDevice::get_erase_value() const {
+    return m_bd->get_erase_value();
+}
+
+bd_size_t SlicingBlockDevice::size() const {
+    return m_stop > m_start ? m_stop - m_start : 0;
+}
+
+const char* SlicingBlockDevice::get_type() const {
+    return m_bd->get_type();
+}
+
+} // namespace mbed
@@ -0,0 +1,184 @@
+#include "rtos/Thread.h"
+#include "rtos/ThisThread.h"
+#include "platform/mbed_stats.h"
+
+#include <cstdint>
+#include <mutex>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+// Stack reserved for main on the target (rtos.main-thread-stack-size)
+#define MAIN_THREAD_STACK_SIZE 4096
+
+namespace rtos {
+
+/// Threads that were started, for the statistics. Main is not a Thread and counts separately.
+struct ThreadRegistry {
+    struct Entry {
+        osThreadId_t    id;
+        uint32_t        stack_size;
+    };
+
+    std::mutex          mutex;
+    std::vector<Entry>  entries;
+
+    // Never destroyed: detached threads may still run while the process exits
+    static ThreadRegistry& get(void){
+        static ThreadRegistry* registry = new ThreadRegistry;
+        return *registry;
+    }
+
+    void add(const Thread* thread){
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.push_back({thread->m_id, thread->m_stack_size});
+    }
+
+    void remove(const Thread* thread){
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::size_t i = 0; i < entries.size(); i++){
+            if (entries[i].id == thread->m_id){
+                entries.erase(entries.begin() + i);
+                return;
+            }
+        }
+    }
+};
+
+} // namespace rtos
+
+namespace {
+
+char main_thread_id;
+
+thread_local osThreadId_t current_id = &main_thread_id;
+thread_local const char* current_name = "main";
+thread_local pid_t current_tid = 0;
+
+/**
+ * Linux only lowers the priority of a thread without privileges, so priorities
+ * above normal run as normal. Four priority levels make one nice level.
+ */
+void apply_priority(pid_t tid, osPriority priority){
+    const int nice = priority < osPriorityNormal ? (osPriorityNormal - priority) / 4 : 0;
+    setpriority(PRIO_PROCESS, static_cast<id_t>(tid), nice);
+}
+
+/// Thread identifiers are 32 bits wide in the statistics, as on the target.
+unsigned long stats_thread_id(const void* id){
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(id));
+}
+
+} // namespace
+
+namespace rtos {
+
+Thread::Thread(osPriority priority, uint32_t stack_size, unsigned char* stack_mem, const char* name):
+    m_priority(priority), m_stack_size(stack_size), m_name(name), m_id(nullptr){
+    (void)stack_mem;
+}
+
+Thread::~Thread(){
+    if (m_id != nullptr){
+        ThreadRegistry::get().remove(this);
+    }
+    if (m_thread.joinable()){
+        m_thread.detach();
+    }
+}
+
+osStatus Thread::start(mbed::Callback<void()> task){
+    if (m_id != nullptr){
+        return osErrorResource;
+    }
+    m_id = this;
+    ThreadRegistry::get().add(this);
+
+    m_thread = std::thread([this, task]() {
+        current_id = m_id;
+        current_name = m_name != nullptr ? m_name : "application_unnamed_thread";
+        current_tid = static_cast<pid_t>(syscall(SYS_gettid));
+
+        // Linux limits thread names to 15 characters
+        char name[16];
+        snprintf(name, sizeof(name), "%s", current_name);
+        pthread_setname_np(pthread_self(), name);
+        apply_priority(current_tid, m_priority);
+
+        task();
+    });
+    return osOK;
+}
+
+osStatus Thread::join(){
+    if (!m_thread.joinable() || m_thread.get_id() == std::this_thread::get_id()){
+        return osErrorResource;
+    }
+    m_thread.join();
+    return osOK;
+}
+
+osStatus Thread::set_priority(osPriority priority){
+    m_priority = priority;
+    if (current_id == m_id){
+        apply_priority(current_tid, priority);
+    }
+    return osOK;
+}
+
+osPriority Thread::get_priority() const {
+    return m_priority;
+}
+
+uint32_t Thread::stack_size() const {
+    return m_stack_size;
+}
+
+const char* Thread::get_name() const {
+    return m_name;
+}
+
+osThreadId_t Thread::get_id() const {
+    return m_id;
+}
+
+osThreadId_t ThisThread::get_id(){
+    return current_id;
+}
+
+const char* ThisThread::get_name(){
+    return current_name;
+}
+
+} // namespace rtos
+
+uint32_t osThreadGetCount(void){
+    rtos::ThreadRegistry& registry = rtos::ThreadRegistry::get();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return static_cast<uint32_t>(registry.entries.size() + 1);
+}
+
+void mbed_stats_stack_get(mbed_stats_stack_t* stats){
+    rtos::ThreadRegistry& registry = rtos::ThreadRegistry::get();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    *stats = {0, 0, MAIN_THREAD_STACK_SIZE, 1};
+    for (const rtos::ThreadRegistry::Entry& entry : registry.entries){
+        stats->reserved_size += entry.stack_size;
+        stats->stack_cnt++;
+    }
+}
+
+std::size_t mbed_stats_stack_get_each(mbed_stats_stack_t* stats, std::size_t count){
+    rtos::ThreadRegistry& registry = rtos::ThreadRegistry::get();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::size_t filled = 0;
+    if (filled < count){
+        stats[filled++] = {stats_thread_id(&main_thread_id), 0, MAIN_THREAD_STACK_SIZE, 1};
+    }
+    for (std::size_t i = 0; i < registry.entries.size() && filled < count; i++){
+        stats[filled++] = {stats_thread_id(registry.entries[i].id), 0, registry.entries[i].stack_size, 1};
+    }
+    return filled;
+}
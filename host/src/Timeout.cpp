@@ -0,0 +1,118 @@
+#include "drivers/Timeout.h"
+#include "platform/CriticalSectionLock.h"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "mbed_host.h"
+
+namespace mbed {
+
+/**
+ * @class InterruptThread
+ * @brief Runs the handlers of all Timeouts when they are due, standing in for the
+ * ticker interrupt of the target.
+ *
+ * Handlers run inside a critical section. attach() and detach() enter it too
+ * before they change the schedule, so a handler never runs once its Timeout was
+ * detached or destroyed. Lock order: critical section, then the schedule mutex.
+ */
+class InterruptThread {
+    public:
+        // Never destroyed: the thread runs until the process exits
+        static InterruptThread& get(void){
+            static InterruptThread* instance = new InterruptThread;
+            return *instance;
+        }
+
+        void schedule(Timeout* timeout, std::chrono::steady_clock::time_point due){
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                remove(timeout);
+                m_pending.emplace(due, timeout);
+            }
+            m_changed.notify_one();
+        }
+
+        void unschedule(Timeout* timeout){
+            std::lock_guard<std::mutex> lock(m_mutex);
+            remove(timeout);
+        }
+
+    private:
+        std::mutex              m_mutex;
+        std::condition_variable m_changed;
+        std::multimap<std::chrono::steady_clock::time_point, Timeout*> m_pending;
+        std::thread             m_thread;
+
+        InterruptThread(): m_thread(&InterruptThread::run, this){
+            m_thread.detach();
+        }
+
+        void remove(Timeout* timeout){
+            for (auto entry = m_pending.begin(); entry != m_pending.end(); ++entry){
+                if (entry->second == timeout){
+                    m_pending.erase(entry);
+                    return;
+                }
+            }
+        }
+
+        bool due(void) const {
+            return !m_pending.empty() && m_pending.begin()->first <= std::chrono::steady_clock::now();
+        }
+
+        void run(void){
+            pthread_setname_np(pthread_self(), "interrupts");
+            mbed_host::set_isr_active(true);
+            while (true){
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    while (!due()){
+                        if (m_pending.empty()){
+                            m_changed.wait(lock);
+                        } else {
+                            m_changed.wait_until(lock, m_pending.begin()->first);
+                        }
+                    }
+                }
+
+                // The schedule is checked again inside the critical section, a detach may have come first
+                CriticalSectionLock critical;
+                while (true){
+                    Callback<void()> handler;
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        if (!due()){
+                            break;
+                        }
+                        handler = m_pending.begin()->second->m_handler;
+                        m_pending.erase(m_pending.begin());
+                    }
+                    handler();
+                }
+            }
+        }
+};
+
+Timeout::Timeout(){
+}
+
+Timeout::~Timeout(){
+    detach();
+}
+
+void Timeout::attach(Callback<void()> func, std::chrono::microseconds t){
+    CriticalSectionLock critical;
+    m_handler = func;
+    InterruptThread::get().schedule(this, std::chrono::steady_clock::now() + t);
+}
+
+void Timeout::detach(){
+    CriticalSectionLock critical;
+    InterruptThread::get().unschedule(this);
+}
+
+} // namespace mbed
@@ -0,0 +1,19 @@
+// mbed_host.h
+#ifndef MBED_HOST_INTERNAL_H
+#define MBED_HOST_INTERNAL_H
+
+#include <chrono>
+
+// Shared by the shim's sources, not part of the Mbed API
+
+namespace mbed_host {
+
+/// Returns the time the process started, the zero of the RTOS clock and the CPU statistics.
+std::chrono::steady_clock::time_point process_start(void);
+
+/// Marks the calling thread as running interrupt handlers.
+void set_isr_active(bool active);
+
+} // namespace mbed_host
+
+#endif // MBED_HOST_INTERNAL_H
@@ -0,0 +1,52 @@
+#include "platform/mbed_stats.h"
+
+#include <chrono>
+#include <cstdint>
+#include <malloc.h>
+#include <mutex>
+#include <sys/resource.h>
+
+#include "mbed_host.h"
+
+namespace {
+
+std::mutex heap_mutex;
+unsigned long heap_max_size = 0;
+
+uint64_t to_us(const struct timeval& time){
+    return static_cast<uint64_t>(time.tv_sec) * 1000000 + static_cast<uint64_t>(time.tv_usec);
+}
+
+} // namespace
+
+/**
+ * mallinfo2() only knows the current allocations, so the maximum is the highest
+ * current size seen by a call and the cumulative and allocation counts stay 0.
+ */
+void mbed_stats_heap_get(mbed_stats_heap_t* stats){
+    const struct mallinfo2 info = mallinfo2();
+    const unsigned long current_size = static_cast<unsigned long>(info.uordblks + info.hblkhd);
+
+    std::lock_guard<std::mutex> lock(heap_mutex);
+    if (current_size > heap_max_size){
+        heap_max_size = current_size;
+    }
+    *stats = {current_size, heap_max_size, 0, static_cast<unsigned long>(info.arena + info.hblkhd), 0, 0, 0};
+}
+
+/**
+ * Idle is the wall time minus the CPU time of all threads, which equals the idle
+ * time of a single core as long as the threads run one at a time, as on the
+ * target. Waiting threads sleep, so there is no deep sleep.
+ */
+void mbed_stats_cpu_get(mbed_stats_cpu_t* stats){
+    const uint64_t uptime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - mbed_host::process_start()).count());
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    const uint64_t busy = to_us(usage.ru_utime) + to_us(usage.ru_stime);
+    const uint64_t idle = uptime > busy ? uptime - busy : 0;
+
+    *stats = {uptime, idle, idle, 0};
+}
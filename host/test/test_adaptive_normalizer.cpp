@@ -0,0 +1,214 @@
+/*
+ * Replays traces of decimated values through OnlineMinMax and AdaptiveNormalizer.
+ *
+ * Windows of VECTOR_SIZE values slide over each trace with a hop of 1 and of 10,
+ * as main() hands them on. After every window the bounds must equal the minimum
+ * and maximum of the values a brute force search finds in the horizon: the
+ * values of the block being filled and of the last NORMALIZATION_BLOCK_COUNT
+ * completed blocks, widened to the minimum span around their centre. Every
+ * output must equal the value scaled between those bounds and lie in [0, 1],
+ * and the bounds must forget a spike once it has left the horizon.
+ *
+ * Built in are the traces of both channels of SimulatedAD7124 at one value per
+ * 6 s, with its hourly sine, noise and spikes, a drifting electrode and a flat
+ * signal. Further traces can be passed as files of signed 24-bit codes, one per
+ * line, e.g. recorded on a node.
+ *
+ * Usage: test_adaptive_normalizer [trace file ...]
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "adc/SimulatedAD7124.h"
+#include "preprocessing/AdaptiveNormalizer.h"
+#include "preprocessing/OnlineMinMax.h"
+#include "utils/Conversion.h"
+#include "utils/FixedPoint.h"
+#include "utils/constants.h"
+
+// A shorter horizon than main()'s day, so the traces cover many of them
+#define NORMALIZATION_BLOCK_COUNT 24
+#define NORMALIZATION_BLOCK_LENGTH 60
+#define NORMALIZATION_MIN_SPAN 0.4f   // mV, as in main()
+#define DATABITS 8388608
+#define VREF 2.5f
+#define GAIN 4.0f
+#define TRACE_LENGTH 20000             // values, about 33 hours at 6 s per value
+#define VALUE_PERIOD_US 6000000ULL
+#define OUTPUT_TOLERANCE 1e-5
+
+static const double MV_PER_UNIT = (VREF / GAIN) * 1000.0 / DATABITS / 256.0;
+
+struct Trace {
+    std::string name;
+    std::vector<int32_t> codes;
+};
+
+static bool failed = false;
+
+static void check(bool condition, const std::string& what){
+    if (!condition){
+        printf("%s: FAILED\n", what.c_str());
+        failed = true;
+    }
+}
+
+/// Bounds a brute force search finds in the horizon after count values, in Q31 units.
+static void reference_bounds(const std::vector<int32_t>& codes, std::size_t count, double& lower, double& upper){
+    const std::size_t completed = count / NORMALIZATION_BLOCK_LENGTH;
+    const std::size_t kept = std::min<std::size_t>(completed, NORMALIZATION_BLOCK_COUNT);
+    const std::size_t first = (completed - kept) * NORMALIZATION_BLOCK_LENGTH;
+    lower = upper = static_cast<double>(codes[first]) * 256.0;
+    for (std::size_t i = first; i < count; i++){
+        lower = std::min(lower, static_cast<double>(codes[i]) * 256.0);
+        upper = std::max(upper, static_cast<double>(codes[i]) * 256.0);
+    }
+}
+
+static void replay_min_max(const Trace& trace){
+    OnlineMinMax min_max(NORMALIZATION_BLOCK_COUNT, NORMALIZATION_BLOCK_LENGTH);
+    check(!min_max.hasValues(), trace.name + ": empty horizon");
+    for (std::size_t n = 0; n < trace.codes.size(); n++){
+        min_max.update(static_cast<float>(trace.codes[n]) * 256.0f);
+        double lower, upper;
+        reference_bounds(trace.codes, n + 1, lower, upper);
+        if (min_max.getMinValue() != lower || min_max.getMaxValue() != upper){
+            check(false, trace.name + ": OnlineMinMax bounds after value " + std::to_string(n));
+            return;
+        }
+    }
+    printf("%s: OnlineMinMax bounds match the horizon after each of %zu values\n", trace.name.c_str(), trace.codes.size());
+}
+
+static void replay_normalizer(const Trace& trace, std::size_t hop){
+    AdaptiveNormalizer normalizer(NORMALIZATION_BLOCK_COUNT, NORMALIZATION_BLOCK_LENGTH, NORMALIZATION_MIN_SPAN,
+                                  DATABITS, VREF, GAIN);
+    const double min_span = NORMALIZATION_MIN_SPAN / MV_PER_UNIT;
+    const std::string name = trace.name + " hop " + std::to_string(hop);
+    std::vector<std::array<uint8_t, 3>> window(VECTOR_SIZE);
+    std::vector<float> outputs;
+    double worst = 0.0;
+
+    for (std::size_t end = VECTOR_SIZE; end <= trace.codes.size(); end += hop){
+        for (std::size_t i = 0; i < VECTOR_SIZE; i++){
+            window[i] = signed_code_to_bytes(trace.codes[end - VECTOR_SIZE + i]);
+        }
+        const std::size_t new_values = (end == VECTOR_SIZE) ? VECTOR_SIZE : hop;
+        normalizer.process(window.data(), VECTOR_SIZE, new_values, 1.0f, outputs);
+
+        double lower, upper;
+        reference_bounds(trace.codes, end, lower, upper);
+        if (upper - lower < min_span){
+            const double centre = 0.5 * (lower + upper);
+            lower = centre - 0.5 * min_span;
+            upper = centre + 0.5 * min_span;
+        }
+        const double tolerance_mv = 1e-6 * (std::fabs(lower) + std::fabs(upper)) * MV_PER_UNIT + 1e-9;
+        if (std::fabs(normalizer.get_min() - lower * MV_PER_UNIT) > tolerance_mv ||
+            std::fabs(normalizer.get_max() - upper * MV_PER_UNIT) > tolerance_mv){
+            check(false, name + ": bounds of the window ending at value " + std::to_string(end));
+            return;
+        }
+
+        for (std::size_t i = 0; i < VECTOR_SIZE; i++){
+            const double expected = (static_cast<double>(trace.codes[end - VECTOR_SIZE + i]) * 256.0 - lower) / (upper - lower);
+            worst = std::max(worst, std::fabs(outputs[i] - expected));
+            if (outputs[i] < -OUTPUT_TOLERANCE || outputs[i] > 1.0 + OUTPUT_TOLERANCE){
+                check(false, name + ": output outside [0, 1] in the window ending at value " + std::to_string(end));
+                return;
+            }
+        }
+    }
+    check(worst <= OUTPUT_TOLERANCE, name + ": outputs scaled between the bounds");
+    printf("%s: %zu values, outputs within %.1e of the reference\n", name.c_str(), trace.codes.size(), worst);
+}
+
+// A spike raises the upper bound for one horizon and no longer
+static void replay_spike(void){
+    const std::size_t horizon = NORMALIZATION_BLOCK_COUNT * NORMALIZATION_BLOCK_LENGTH;
+    const std::size_t spike = 3 * VECTOR_SIZE;
+    AdaptiveNormalizer normalizer(NORMALIZATION_BLOCK_COUNT, NORMALIZATION_BLOCK_LENGTH, NORMALIZATION_MIN_SPAN,
+                                  DATABITS, VREF, GAIN);
+    std::vector<std::array<uint8_t, 3>> window(VECTOR_SIZE);
+    std::vector<float> outputs;
+    float raised = 0.0f;
+    for (std::size_t end = VECTOR_SIZE; end <= spike + horizon + 2 * NORMALIZATION_BLOCK_LENGTH; end++){
+        for (std::size_t i = 0; i < VECTOR_SIZE; i++){
+            const std::size_t index = end - VECTOR_SIZE + i;
+            window[i] = signed_code_to_bytes(index == spike ? 100000 : static_cast<int32_t>(index % 50) * 100);
+        }
+        normalizer.process(window.data(), VECTOR_SIZE, (end == VECTOR_SIZE) ? VECTOR_SIZE : 1, 1.0f, outputs);
+        if (end == spike + 1){
+            raised = normalizer.get_max();
+        }
+    }
+    check(raised > 100000 * 256 * MV_PER_UNIT * 0.999, "spike raises the upper bound");
+    // The remaining values span 4900 codes, widened to the minimum span of about 5400
+    check(normalizer.get_max() < 10000 * 256 * MV_PER_UNIT, "spike is forgotten after the horizon");
+}
+
+static Trace simulator_trace(int channel){
+    Trace trace = {"simulator channel " + std::to_string(channel), std::vector<int32_t>(TRACE_LENGTH)};
+    for (std::size_t i = 0; i < TRACE_LENGTH; i++){
+        trace.codes[i] = SimulatedAD7124::synthetic_trace(channel, i * VALUE_PERIOD_US);
+    }
+    return trace;
+}
+
+// An electrode drifting over a large part of the full scale, with a small daily signal on top
+static Trace drift_trace(void){
+    Trace trace = {"drift", std::vector<int32_t>(TRACE_LENGTH)};
+    for (std::size_t i = 0; i < TRACE_LENGTH; i++){
+        trace.codes[i] = -6000000 + static_cast<int32_t>(i * 500) + static_cast<int32_t>(3000.0 * std::sin(i / 2300.0));
+    }
+    return trace;
+}
+
+// Constant but for one code of noise, the minimum span sets the bounds
+static Trace flat_trace(void){
+    Trace trace = {"flat", std::vector<int32_t>(TRACE_LENGTH)};
+    for (std::size_t i = 0; i < TRACE_LENGTH; i++){
+        trace.codes[i] = 4321 + static_cast<int32_t>(i * 7 % 3) - 1;
+    }
+    return trace;
+}
+
+static bool load_trace(const char* path, Trace& trace){
+    FILE* file = fopen(path, "r");
+    if (file == nullptr){
+        return false;
+    }
+    trace.name = path;
+    long code;
+    while (fscanf(file, "%ld", &code) == 1){
+        trace.codes.push_back(static_cast<int32_t>(std::max(-8388608L, std::min(8388607L, code))));
+    }
+    fclose(file);
+    return trace.codes.size() >= VECTOR_SIZE;
+}
+
+int main(int argc, char* argv[]){
+    std::vector<Trace> traces = {simulator_trace(0), simulator_trace(1), drift_trace(), flat_trace()};
+    for (int i = 1; i < argc; i++){
+        Trace trace;
+        if (!load_trace(argv[i], trace)){
+            fprintf(stderr, "%s: not a trace of at least %d codes\n", argv[i], VECTOR_SIZE);
+            return EXIT_FAILURE;
+        }
+        traces.push_back(trace);
+    }
+
+    for (const Trace& trace : traces){
+        replay_min_max(trace);
+        replay_normalizer(trace, 1);
+        replay_normalizer(trace, 10);
+    }
+    replay_spike();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
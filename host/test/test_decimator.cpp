@@ -0,0 +1,107 @@
+/*
+ * Frequency response of the Decimator, measured with sine sweeps.
+ *
+ * A sine of half full scale at each test frequency is decimated and the RMS
+ * of the settled output is compared with that of the input. Frequencies are
+ * given in multiples of the output rate: the passband up to
+ * DECIMATOR_PASSBAND must stay within DECIMATOR_RIPPLE_DB, and everything
+ * from the output Nyquist frequency (0.5) up to the input Nyquist frequency
+ * folds back into the output and must be rejected by DECIMATOR_REJECTION_DB.
+ * The stopband is swept up to the input Nyquist frequency, ratio / 2 output
+ * rates, finely up to SWEEP_DENSE_LIMIT and coarsely beyond.
+ * Ratios below DECIMATOR_FLAT_RATIO are only checked for rejection.
+ *
+ * Usage: test_decimator
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "preprocessing/Decimator.h"
+
+#define DECIMATOR_PASSBAND 0.3f       // of the output rate
+#define DECIMATOR_RIPPLE_DB 0.5f
+#define DECIMATOR_FLAT_RATIO 16       // smallest ratio whose passband is compensated
+#define DECIMATOR_REJECTION_DB 65.0f
+#define SWEEP_STEP 0.01               // of the output rate
+#define SWEEP_DENSE_LIMIT 8.0         // the transition bands lie below, swept at SWEEP_STEP
+#define SWEEP_COARSE_STEP 0.1         // above, where only the CIC's sidelobes remain
+#define SETTLING_OUTPUTS 40           // outputs skipped while the filters settle
+#define MEASURED_OUTPUTS 400
+
+static const double PI = 3.14159265358979323846;
+static const double AMPLITUDE = 4194304.0; // half full scale of a 24-bit code
+
+/// Gain in dB of the decimator for a sine at frequency times the output rate.
+static double gain_db(unsigned int ratio, double frequency){
+    Decimator decimator(ratio);
+    const std::size_t count = (SETTLING_OUTPUTS + MEASURED_OUTPUTS) * ratio;
+    std::vector<int32_t> inputs(count);
+    for (std::size_t i = 0; i < count; i++){
+        // A random phase would be better, a fixed odd offset keeps the sweep reproducible
+        inputs[i] = static_cast<int32_t>(std::lround(AMPLITUDE * std::sin(2.0 * PI * frequency * i / ratio + 0.3)));
+    }
+    std::vector<int32_t> outputs(count / ratio + 1);
+    const std::size_t produced = decimator.process(inputs.data(), count, outputs.data());
+
+    // A tone that aliases to DC shows as offset, so the mean is not removed
+    double sum_squares = 0.0;
+    for (std::size_t i = SETTLING_OUTPUTS; i < produced; i++){
+        sum_squares += static_cast<double>(outputs[i]) * outputs[i];
+    }
+    const double n = static_cast<double>(produced - SETTLING_OUTPUTS);
+    const double rms = std::sqrt(sum_squares / n);
+    return 20.0 * std::log10(std::max(rms, 1e-3) / (AMPLITUDE / std::sqrt(2.0)));
+}
+
+static bool check_ratio(unsigned int ratio){
+    double ripple_min = 0.0;
+    double ripple_max = -1000.0;
+    for (double f = SWEEP_STEP; f <= DECIMATOR_PASSBAND + 1e-9; f += SWEEP_STEP){
+        const double gain = gain_db(ratio, f);
+        ripple_min = std::min(ripple_min, gain);
+        ripple_max = std::max(ripple_max, gain);
+    }
+
+    double worst = -1000.0;
+    double worst_frequency = 0.0;
+    const double limit = ratio / 2.0;
+    for (double f = 0.5; f <= limit + 1e-9; f += (f < SWEEP_DENSE_LIMIT) ? SWEEP_STEP : SWEEP_COARSE_STEP){
+        const double gain = gain_db(ratio, f);
+        if (gain > worst){
+            worst = gain;
+            worst_frequency = f;
+        }
+    }
+
+    const bool flat = ratio < DECIMATOR_FLAT_RATIO || (ripple_min >= -DECIMATOR_RIPPLE_DB && ripple_max <= DECIMATOR_RIPPLE_DB);
+    const bool rejected = worst <= -DECIMATOR_REJECTION_DB;
+    printf("ratio %u: passband to %.2f %+.3f/%+.3f dB, alias rejection %.1f dB (at %.2f): %s\n", ratio,
+           DECIMATOR_PASSBAND, ripple_min, ripple_max, -worst, worst_frequency, flat && rejected ? "ok" : "FAILED");
+    return flat && rejected;
+}
+
+int main(){
+    // The smallest ratio, a small one, main()'s ratio at 50 conversions per second and channel and the largest
+    const unsigned int ratios[] = {2, 20, 300, Decimator::MAX_RATIO};
+    bool passed = true;
+    for (unsigned int ratio : ratios){
+        passed = check_ratio(ratio) && passed;
+    }
+
+    // Ratios derived from a rate are even and within range
+    const struct { float rate; float period; unsigned int ratio; } derived[] = {
+        {50.0f, 6.0f, 300}, {50.5f, 6.0f, 304}, {49.9f, 6.0f, 300}, {0.1f, 6.0f, 2}, {1000.0f, 6.0f, Decimator::MAX_RATIO}
+    };
+    for (const auto& entry : derived){
+        const unsigned int ratio = Decimator::ratio_for_period(entry.rate, entry.period);
+        if (ratio != entry.ratio){
+            printf("ratio for %.1f/s at %.1f s: %u, expected %u: FAILED\n", entry.rate, entry.period, ratio, entry.ratio);
+            passed = false;
+        }
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
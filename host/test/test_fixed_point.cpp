@@ -0,0 +1,140 @@
+/*
+ * Agreement of the Q31/Q15 preprocessing path with the float path.
+ *
+ * Every 24-bit code must convert to Q31 and to float without any rounding, so
+ * both paths share bit-identical bounds. Windows of several signals are then
+ * normalised by AdaptiveNormalizer::process() with a factor of 1 and by
+ * process_q15(), with and without the line of a LinearDetrend subtracted.
+ * The Q15 outputs must not differ from the float outputs rounded
+ * to Q15 by more than FIXED_POINT_TOLERANCE_LSB, the bound documented in
+ * AdaptiveNormalizer.h, and both must lie in [0, 1], also where detrending
+ * moves older values of the window outside the bounds.
+ *
+ * Usage: test_fixed_point
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "preprocessing/AdaptiveNormalizer.h"
+#include "preprocessing/LinearDetrend.h"
+#include "utils/Conversion.h"
+#include "utils/FixedPoint.h"
+#include "utils/constants.h"
+
+#define FIXED_POINT_TOLERANCE_LSB 1
+#define TEST_WINDOWS 4000
+#define TEST_BLOCK_COUNT 8            // a short horizon, so the bounds move during the test
+#define TEST_BLOCK_LENGTH 100
+#define TEST_MIN_SPAN 0.4f            // mV, as in main()
+#define DATABITS 8388608
+#define VREF 2.5f
+#define GAIN 4.0f
+
+static const double PI = 3.14159265358979323846;
+
+/// Signed 24-bit code of a test signal at index i.
+typedef int32_t (*signal_t)(std::size_t i);
+
+static uint32_t noise(std::size_t i){
+    uint32_t hash = static_cast<uint32_t>(i) * 2654435761u;
+    hash ^= hash >> 13;
+    hash *= 0x5bd1e995u;
+    hash ^= hash >> 15;
+    return hash;
+}
+
+// A slow sine with noise and occasional spikes, like SimulatedAD7124::synthetic_trace()
+static int32_t sine_signal(std::size_t i){
+    int32_t code = static_cast<int32_t>(2000.0 * std::sin(2.0 * PI * i / 700.0)) + static_cast<int32_t>(noise(i) & 0x1F) - 16;
+    return (noise(i) % 500 == 0) ? code + 50000 : code;
+}
+
+// A flat signal with a few codes of noise, normalised against the widened minimum span
+static int32_t flat_signal(std::size_t i){
+    return 1234 + static_cast<int32_t>(noise(i) & 0x7) - 4;
+}
+
+// A steep drift over most of the full scale, detrending leaves the sawtooth's jumps
+static int32_t drift_signal(std::size_t i){
+    return static_cast<int32_t>(i * 3000 % 14000000) - 7000000 + static_cast<int32_t>(noise(i) & 0xFF);
+}
+
+// Alternating steps between both ends of the full scale
+static int32_t step_signal(std::size_t i){
+    return ((i / 37) % 2 == 0) ? -0x800000 + static_cast<int32_t>(noise(i) & 0xF) : 0x7FFFFF - static_cast<int32_t>(noise(i) & 0xF);
+}
+
+// Every 24-bit code is exact as Q31 and as float
+static bool check_conversion(void){
+    for (int32_t code = -0x800000; code <= 0x7FFFFF; code++){
+        const std::array<uint8_t, 3> bytes = signed_code_to_bytes(code);
+        const q31_t value = bytes_to_q31(bytes);
+        if (bytes_to_signed_code(bytes) != code || value != code * 256 ||
+            static_cast<float>(value) != static_cast<float>(code) * 256.0f){
+            printf("code %ld converts to Q31 %ld: FAILED\n", static_cast<long>(code), static_cast<long>(value));
+            return false;
+        }
+    }
+    printf("24-bit codes to Q31 and float: exact\n");
+    return true;
+}
+
+static bool check_signal(const char* name, signal_t signal, bool detrending){
+    AdaptiveNormalizer float_path(TEST_BLOCK_COUNT, TEST_BLOCK_LENGTH, TEST_MIN_SPAN, DATABITS, VREF, GAIN);
+    AdaptiveNormalizer fixed_path(TEST_BLOCK_COUNT, TEST_BLOCK_LENGTH, TEST_MIN_SPAN, DATABITS, VREF, GAIN);
+    LinearDetrend detrend(VECTOR_SIZE);
+
+    std::vector<std::array<uint8_t, 3>> window(VECTOR_SIZE);
+    std::vector<float> float_outputs;
+    std::vector<q15_t> fixed_outputs;
+    long worst = 0;
+    unsigned long exact = 0;
+    unsigned long total = 0;
+    bool in_range = true;
+
+    for (std::size_t n = 0; n < TEST_WINDOWS; n++){
+        // Slide the window by one value, the first window is new as a whole
+        for (std::size_t i = 0; i < VECTOR_SIZE; i++){
+            window[i] = signed_code_to_bytes(signal(n + i));
+        }
+        const std::size_t new_values = (n == 0) ? VECTOR_SIZE : 1;
+        detrend.update(window.data(), VECTOR_SIZE, new_values);
+        const float offset = detrending ? detrend.get_offset() : 0.0f;
+        const float slope = detrending ? detrend.get_slope() : 0.0f;
+
+        float_path.process(window.data(), VECTOR_SIZE, new_values, 1.0f, float_outputs, offset, slope);
+        fixed_path.process_q15(window.data(), VECTOR_SIZE, new_values, fixed_outputs, offset, slope);
+
+        for (std::size_t i = 0; i < VECTOR_SIZE; i++){
+            const q15_t expected = saturate_q15(std::lround(static_cast<double>(float_outputs[i]) * Q15_ONE));
+            const long difference = std::labs(static_cast<long>(fixed_outputs[i]) - expected);
+            worst = std::max(worst, difference);
+            exact += (difference == 0) ? 1 : 0;
+            total++;
+            in_range = in_range && float_outputs[i] >= 0.0f && float_outputs[i] <= 1.0f && fixed_outputs[i] >= 0;
+        }
+    }
+
+    const bool passed = worst <= FIXED_POINT_TOLERANCE_LSB && in_range;
+    printf("%s%s: %.1f %% exact, at most %ld LSB apart, %s [0, 1]: %s\n", name, detrending ? " detrended" : "",
+           100.0 * exact / total, worst, in_range ? "within" : "outside", passed ? "ok" : "FAILED");
+    return passed;
+}
+
+int main(){
+    bool passed = check_conversion();
+
+    const struct { const char* name; signal_t signal; } signals[] = {
+        {"sine", sine_signal}, {"flat", flat_signal}, {"drift", drift_signal}, {"steps", step_signal}
+    };
+    for (const auto& entry : signals){
+        passed = check_signal(entry.name, entry.signal, false) && passed;
+        passed = check_signal(entry.name, entry.signal, true) && passed;
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
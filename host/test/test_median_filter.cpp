@@ -0,0 +1,101 @@
+/*
+ * Sliding median of MedianFilter against a brute force sort of the window.
+ *
+ * Sequences with noise, long runs of equal samples, ramps in both directions
+ * and isolated spikes run through filters of several window lengths, odd and
+ * even. After every sample the median must equal that of the samples in the
+ * window, also while the window fills, and the output must be the median, or
+ * with a threshold the sample itself unless it deviates by more than the threshold.
+ *
+ * Usage: test_median_filter
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "preprocessing/MedianFilter.h"
+
+#define TEST_SAMPLES 20000
+#define TEST_THRESHOLD 500
+
+static uint32_t noise(std::size_t i){
+    uint32_t hash = static_cast<uint32_t>(i) * 2654435761u;
+    hash ^= hash >> 13;
+    hash *= 0x5bd1e995u;
+    hash ^= hash >> 15;
+    return hash;
+}
+
+/// Sample i of a test sequence: noise, runs, ramps and spikes in turn.
+static int32_t sample(std::size_t i){
+    switch ((i / 500) % 4){
+    case 0:
+        return static_cast<int32_t>(noise(i) % 2000) - 1000;
+    case 1:
+        return static_cast<int32_t>(noise(i / 37) % 5);               // long runs of equal samples
+    case 2:
+        return ((i / 1000) % 2 == 0) ? static_cast<int32_t>(i % 500) * 13 : -static_cast<int32_t>(i % 500) * 13;
+    default:
+        if (noise(i) % 50 == 0){
+            return (noise(i) & 0x100) ? 8388607 : -8388608;              // spikes at both ends of the full scale
+        }
+        return static_cast<int32_t>(noise(i) & 0x3F);
+    }
+}
+
+static int32_t reference_median(const std::vector<int32_t>& samples, std::size_t end, std::size_t window){
+    const std::size_t first = (end > window) ? end - window : 0;
+    std::vector<int32_t> sorted(samples.begin() + first, samples.begin() + end);
+    std::sort(sorted.begin(), sorted.end());
+    const std::size_t count = sorted.size();
+    if (count % 2 == 1){
+        return sorted[count / 2];
+    }
+    const int32_t lower = sorted[count / 2 - 1];
+    return lower + (sorted[count / 2] - lower) / 2;
+}
+
+static bool check_window(const std::vector<int32_t>& samples, std::size_t window, int32_t threshold){
+    MedianFilter filter(window, threshold);
+    for (std::size_t n = 0; n < samples.size(); n++){
+        const int32_t output = filter.update(samples[n]);
+        const int32_t median = reference_median(samples, n + 1, window);
+        const int32_t deviation = (samples[n] > median) ? samples[n] - median : median - samples[n];
+        const int32_t expected = (threshold > 0 && deviation <= threshold) ? samples[n] : median;
+        if (filter.get_median() != median || output != expected){
+            printf("window %zu, threshold %ld: median %ld instead of %ld, output %ld instead of %ld at sample %zu: FAILED\n",
+                   window, static_cast<long>(threshold), static_cast<long>(filter.get_median()), static_cast<long>(median),
+                   static_cast<long>(output), static_cast<long>(expected), n);
+            return false;
+        }
+    }
+    printf("window %zu, threshold %ld: ok\n", window, static_cast<long>(threshold));
+    return true;
+}
+
+int main(){
+    std::vector<int32_t> samples(TEST_SAMPLES);
+    for (std::size_t i = 0; i < samples.size(); i++){
+        samples[i] = sample(i);
+    }
+
+    bool passed = true;
+    const std::size_t windows[] = {2, 3, 4, 7, 8, 31, 64};
+    for (std::size_t window : windows){
+        passed = check_window(samples, window, 0) && passed;
+        passed = check_window(samples, window, TEST_THRESHOLD) && passed;
+    }
+
+    // Windows below 2 pass every sample through
+    MedianFilter disabled(1, 0);
+    for (std::size_t i = 0; i < 100; i++){
+        if (disabled.update(samples[i]) != samples[i]){
+            printf("window 1 changes sample %zu: FAILED\n", i);
+            passed = false;
+            break;
+        }
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,178 @@
+/*
+ * Unit and stress tests of SpscRing.
+ *
+ * The unit checks run on one thread: order, capacity, overflow counting, batch
+ * pops and many wraps of the free running indices. The stress checks run one
+ * std::thread per side, as the DRDY handler and the acquisition thread do on the
+ * board. Each record carries a sequence number and two values derived from it,
+ * so a record read while it is written, lost or duplicated shows as a broken
+ * sequence. Once with a producer retrying on a full ring, which must deliver
+ * every record, and once with a producer dropping them, where every record must
+ * either arrive in order or be counted as overflow.
+ *
+ * Usage: test_spsc_ring [records]
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "utils/SpscRing.h"
+
+#define STRESS_RECORDS 2000000
+#define STRESS_CAPACITY 64      // small, so both sides meet at full and empty often
+#define STRESS_BATCH 7          // odd, so batches do not line up with the ring
+
+/// Record of the stress tests, large enough to be copied in several words.
+struct Record {
+    uint32_t sequence;
+    uint32_t inverse;
+    uint64_t square;
+};
+
+static Record make_record(uint32_t sequence){
+    return {sequence, ~sequence, static_cast<uint64_t>(sequence) * sequence};
+}
+
+static bool intact(const Record& record){
+    return record.inverse == ~record.sequence && record.square == static_cast<uint64_t>(record.sequence) * record.sequence;
+}
+
+static bool failed = false;
+
+static void check(bool condition, const char* what){
+    if (!condition){
+        printf("%s: FAILED\n", what);
+        failed = true;
+    }
+}
+
+static void test_single_thread(void){
+    SpscRing<uint32_t, 8> ring;
+    uint32_t value = 0;
+    check(ring.empty() && ring.size() == 0 && !ring.pop(value), "a new ring is empty");
+    check(ring.capacity() == 8, "capacity");
+
+    // Every slot is usable, the next record is dropped and counted
+    for (uint32_t i = 0; i < 8; i++){
+        check(ring.push(i), "push into a ring with free slots");
+    }
+    check(ring.size() == 8 && !ring.push(99) && ring.get_overflow_count() == 1, "push into a full ring");
+    check(ring.get_high_watermark() == 8, "high watermark at full");
+
+    // Records come out in push order, a batch stops at the records present
+    uint32_t batch[16];
+    check(ring.pop(batch, 3) == 3 && batch[0] == 0 && batch[1] == 1 && batch[2] == 2, "batch pop in order");
+    check(ring.pop(value) && value == 3, "single pop in order");
+    check(ring.pop(batch, 16) == 4 && batch[0] == 4 && batch[3] == 7, "batch pop limited to the stored records");
+    check(ring.empty() && ring.pop(batch, 16) == 0, "empty after draining");
+
+    // Many wraps of the free running indices with the ring partly filled
+    uint32_t next_push = 0;
+    uint32_t next_pop = 0;
+    bool in_order = true;
+    for (int round = 0; round < 10000; round++){
+        const int pushes = 1 + round % 5;
+        for (int i = 0; i < pushes && ring.size() < ring.capacity(); i++){
+            ring.push(next_push++);
+        }
+        const std::size_t popped = ring.pop(batch, 1 + round % 4);
+        for (std::size_t i = 0; i < popped; i++){
+            in_order = in_order && batch[i] == next_pop++;
+        }
+    }
+    check(in_order && ring.size() == next_push - next_pop, "order and size across wraps");
+    check(ring.get_overflow_count() == 1, "no overflow while free slots are checked");
+}
+
+static void test_retrying_producer(uint32_t records){
+    static SpscRing<Record, STRESS_CAPACITY> ring;
+    uint32_t full = 0;
+
+    std::thread producer([&]() {
+        for (uint32_t sequence = 0; sequence < records; sequence++){
+            while (!ring.push(make_record(sequence))){
+                full++;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ok = true;
+    Record batch[STRESS_BATCH];
+    while (expected < records && ok){
+        const std::size_t count = ring.pop(batch, STRESS_BATCH);
+        if (count == 0){
+            std::this_thread::yield(); // lets the producer run on a single core
+        }
+        for (std::size_t i = 0; i < count; i++){
+            ok = ok && intact(batch[i]) && batch[i].sequence == expected;
+            expected++;
+        }
+    }
+    while (expected < records){
+        // After a failure the producer is drained, so it does not wait on a full ring forever
+        expected += ring.pop(batch, STRESS_BATCH);
+        std::this_thread::yield();
+    }
+    producer.join();
+
+    // Every refused push is counted as overflow, the record is then pushed again
+    check(ok && expected == records && ring.empty(), "retrying producer: every record arrives once, in order, intact");
+    check(ring.get_overflow_count() == full, "retrying producer: refused pushes are counted");
+    printf("retrying producer: %lu records, %lu pushes into a full ring, high watermark %lu\n",
+           static_cast<unsigned long>(records), static_cast<unsigned long>(full),
+           static_cast<unsigned long>(ring.get_high_watermark()));
+}
+
+static void test_dropping_producer(uint32_t records){
+    static SpscRing<Record, STRESS_CAPACITY> ring;
+    bool done = false;
+    std::atomic<bool> finished(false);
+
+    std::thread producer([&]() {
+        for (uint32_t sequence = 0; sequence < records; sequence++){
+            ring.push(make_record(sequence));
+            if (sequence % STRESS_CAPACITY == 0){
+                std::this_thread::yield(); // lets the consumer run on a single core
+            }
+        }
+        finished = true;
+    });
+
+    uint32_t received = 0;
+    int64_t last = -1;
+    bool ok = true;
+    Record record;
+    while (!done){
+        // The producer finished before this pass, so it drains the rest
+        done = finished;
+        while (ring.pop(record)){
+            ok = ok && intact(record) && static_cast<int64_t>(record.sequence) > last;
+            last = record.sequence;
+            received++;
+        }
+        std::this_thread::yield();
+    }
+    producer.join();
+
+    check(ok, "dropping producer: records arrive in order and intact");
+    check(received + ring.get_overflow_count() == records, "dropping producer: every record arrives or is counted");
+    printf("dropping producer: %lu records, %lu received, %lu dropped\n", static_cast<unsigned long>(records),
+           static_cast<unsigned long>(received), static_cast<unsigned long>(ring.get_overflow_count()));
+}
+
+int main(int argc, char* argv[]){
+    const long records = argc > 1 ? atol(argv[1]) : STRESS_RECORDS;
+    if (records < 1){
+        fprintf(stderr, "The number of records must be at least 1\n");
+        return EXIT_FAILURE;
+    }
+
+    test_single_thread();
+    test_retrying_producer(static_cast<uint32_t>(records));
+    test_dropping_producer(static_cast<uint32_t>(records));
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -2,19 +2,44 @@
 #ifndef ADC_PROCESS_H_
 #define ADC_PROCESS_H_
 
-// Required for SPI, DigitalIn, DigitalOut, NonCopyable
+// Required for Thread, EventQueue, EventFlags, NonCopyable
 // Handle Body idiom could be applied to remove mbed.h
 // from header entirely
 #include "mbed.h"   
+#include <atomic>
+#include <vector>
+
+#include "adc/AD7124Bus.h"
+#include "adc/AcquisitionStats.h"
+#include "adc/CalibrationStore.h"
+#include "preprocessing/Decimator.h"
+#include "preprocessing/MedianFilter.h"
+
+#include "utils/CircularWindow.h"
+#include "utils/SpscRing.h"
+#include "utils/constants.h"
+
+// Number of raw conversions drained from the ring by the acquisition thread at once
+#define ACQUISITION_BLOCK_SIZE 32
+
+// Capacity of the conversion ring between the DRDY handler and the acquisition thread (power of two)
+#define ACQUISITION_RING_SIZE 256
 
 /**
  * @class AD7124
- * @brief Singleton class for interfacing with the AD7124 using SPI.
+ * @brief Driver of one AD7124 converter on SPI.
  *
  * The AD7124 class provides methods for initializing and interacting with the AD7124
  * Analog-to-Digital Converter (ADC) via SPI. It supports configuration of ADC channels,
- * reading voltage data, and resetting or controlling the device.
+ * reading voltage data, and resetting or controlling the device. All signals go through
+ * an AD7124Bus, which is either the board (MbedAD7124Bus), a SimulatedAD7124 or a port
+ * of an AD7124BusArbiter when several converters share the bus. Each converter has its
+ * own instance, acquisition thread and DRDY thread; getInstance() serves nodes with one.
+ * With COOPERATIVE_SCHEDULING neither thread exists: the reads and blocks run as
+ * handlers of the EventLoop.
  */
+static_assert(ADC_CHANNELS >= 1 && ADC_CHANNELS <= 8, "The AD7124-8 scans at most 8 differential pairs");
+
 class AD7124: private mbed::NonCopyable<AD7124>{
     public:
         /**
@@ -24,39 +49,274 @@ class AD7124: private mbed::NonCopyable<AD7124>{
          */
         static AD7124& getInstance(int spi_frequency);
 
-        // Deleted copy constructor to prevent copying of the singleton instance.
-        AD7124(const AD7124&) = delete;
+        /**
+         * @brief Gets the singleton instance of the AD7124 class on the given bus.
+         * @param bus The bus used if this call creates the instance.
+         * @return Reference to the singleton instance of the AD7124 class.
+         */
+        static AD7124& getInstance(AD7124Bus& bus);
+
+        /**
+         * @brief Resets and initializes the converter on a bus.
+         * @param bus The bus of the converter, e.g. a port of an AD7124BusArbiter.
+         * @param device Number of the converter, 0 to ADC_DEVICES - 1, carried by its mails.
+         */
+        explicit AD7124(AD7124Bus& bus, uint8_t device = 0);
 
-        /// Deleted copy assignment operator to prevent copying of the singleton instance.
+        AD7124(const AD7124&) = delete;
         AD7124& operator=(const AD7124&) = delete;
 
         /**
-         * @brief Reads voltage data from both ADC channels.
+         * @brief Returns the number of the converter.
          */
-        void read_voltage_from_both_channels(unsigned int downsampling_rate, unsigned int vector_size);
+        uint8_t get_device(void) const;
 
-    private:
+        /// Digital filter of a setup (FILTER bits of the filter register).
+        enum class FilterType : uint8_t {
+            Sinc4 = 0,
+            Sinc3 = 2,
+            FastSinc4 = 4,      ///< Fast settling sinc4 (settles in one conversion).
+            FastSinc3 = 5,      ///< Fast settling sinc3 (settles in one conversion).
+            PostFilter = 7      ///< Sinc3 followed by a 50/60 Hz rejecting post filter.
+        };
+
+        /// Post filter, used with FilterType::PostFilter (POST_FILTER bits).
+        enum class PostFilter : uint8_t {
+            Sps27 = 2,          ///< 27.27 SPS, 47 dB rejection of 50/60 Hz.
+            Sps25 = 3,          ///< 25 SPS, 62 dB rejection of 50/60 Hz.
+            Sps20 = 5,          ///< 20 SPS, 86 dB rejection of 50 Hz.
+            Sps16 = 6           ///< 16.67 SPS, 92 dB rejection of 50 Hz.
+        };
 
-        SPI         m_spi;              ///< SPI object for communication with the AD7124.
-        DigitalIn   m_drdy;
-        DigitalOut  m_cs;
-        DigitalOut  m_sync;             
-        int         m_spi_frequency;   ///< SPI clock frequency in Hz. 
-        int         m_flag_0;
-        int         m_flag_1;
-        char        m_read;
-        char        m_write;
+        /// Power mode (POWER_MODE bits of the ADC control register).
+        enum class PowerMode : uint8_t {
+            Low = 0,            ///< Master clock 76.8 kHz.
+            Mid = 1,            ///< Master clock 153.6 kHz.
+            Full = 2            ///< Master clock 614.4 kHz.
+        };
+
+        /// Gain of the programmable gain amplifier (PGA bits of the configuration register).
+        enum class PgaGain : uint8_t {
+            x1 = 0, x2, x4, x8, x16, x32, x64, x128
+        };
+
+        /// Filter and gain of one setup. Channel n uses setup n and the pair AIN(2n)/AIN(2n+1).
+        struct SetupConfig {
+            FilterType filter;
+            uint16_t filter_select;     ///< FS word, 1 to 2047.
+            PostFilter post_filter;
+            bool reject_60_hz;          ///< Adds a notch at 60 Hz to the 50 Hz first notch.
+            bool single_cycle;          ///< Only output fully settled results.
+            PgaGain gain;
+        };
+
+        /// Complete runtime configuration of the converter.
+        struct Configuration {
+            PowerMode power_mode;
+            SetupConfig setups[ADC_CHANNELS];
+        };
+
+        /// Sliding window of decimated values of one channel, as 24-bit offset binary codes.
+        typedef CircularWindow<std::array<uint8_t, 3>, VECTOR_SIZE> ByteWindow;
+
+        /// One conversion as read by the DRDY handler.
+        struct RawConversion {
+            uint32_t timestamp;         ///< Falling edge of DOUT/RDY in microseconds.
+            int32_t code;               ///< Signed 24-bit code (offset binary minus 0x800000).
+            uint8_t channel;            ///< Channel number from the status byte.
+        };
+
+        /**
+         * @brief Applies a configuration atomically.
+         *
+         * The registers are compared with a shadow of the register map and only those
+         * that change are written, in a single SPI transaction. If nothing changes,
+         * acquisition is not interrupted at all. Otherwise it is paused while the
+         * registers are written: the DRDY interrupt is masked, continuous read mode is
+         * left, the changed registers are written, optionally read back, and continuous
+         * read mode is entered again. While acquisition runs, the update executes on the
+         * DRDY thread, so no conversion read interleaves. With COOPERATIVE_SCHEDULING it
+         * runs in place and must be called from the thread dispatching the EventLoop.
+         * @param configuration The configuration to apply.
+         * @param verify Reads the written registers back in a second transaction.
+         * @return True if continuous read mode could be left and, if verified, every
+         *         register read back as written.
+         */
+        bool configure(const Configuration& configuration, bool verify = true);
 
         /**
-        * @brief Private constructor for the AD7124 class.
-        * @param spi_frequency The SPI clock frequency in Hz.
-        */
-        AD7124(int spi_frequency);
+         * @brief Restores the offset and gain calibration from a store, or calibrates.
+         *
+         * The die temperature is measured with the internal sensor. If the store holds
+         * a calibration of the current setups, power mode and a temperature within
+         * temperature_delta, its coefficients are written. Otherwise every setup runs an
+         * internal full-scale (for gains above 1) and zero-scale calibration, which takes
+         * several settling times per setup, and the result is stored. While acquisition
+         * runs, this executes on the DRDY thread or in place like configure().
+         * @param store Store of the coefficients.
+         * @param temperature_delta Largest temperature change in degrees Celsius for which a
+         *        stored calibration is reused.
+         * @param force Calibrates even if the stored calibration applies.
+         * @return False if a calibration timed out or a register did not verify.
+         */
+        bool calibrate(CalibrationStore& store, float temperature_delta, bool force = false);
+
+        /**
+         * @brief Returns the configuration written last.
+         */
+        const Configuration& get_configuration(void) const;
+
+        /**
+         * @brief Returns the output data rate of a setup in a single channel, continuous conversion.
+         * @param setup Index of the setup.
+         */
+        float get_output_data_rate(int setup) const;
 
         /**
-         * @brief Initializes the AD7124 ADC with specific channel flags.
+         * @brief Returns the conversions per second and channel while the sequencer cycles through
+         * all channels. Every channel change requires a fully settled conversion, so this is lower
+         * than the output data rate.
          */
-        void init(bool f0, bool f1);
+        float get_channel_data_rate(void) const;
+
+        /**
+         * @brief Reads voltage data from all ADC_CHANNELS channels.
+         * @param decimation_ratio Number of conversions per channel that are
+         *        decimated into one value of the sliding window.
+         * @param median_window Length of the sliding median applied to the raw
+         *        conversions of each channel. Values below 2 disable it.
+         * @param spike_threshold Deviation from the median in codes above which a
+         *        conversion is replaced by the median. 0 always uses the median.
+         * @note Runs forever on the calling acquisition thread. With COOPERATIVE_SCHEDULING
+         *       it returns once acquisition has started.
+         */
+        void read_voltage_from_channels(unsigned int decimation_ratio, unsigned int median_window,
+                                        int32_t spike_threshold);
+
+        /**
+         * @brief Sets the sliding window of a channel and how often it is handed on.
+         *
+         * May be called from any thread while acquiring. The acquisition thread applies
+         * the change before its next block; a new length restarts the window. A window
+         * is handed to the main thread once it is full and hop new values have been
+         * added since it was handed on last, so inference and transmission scale down
+         * with the hop. The default is a window of VECTOR_SIZE values and a hop of 1.
+         * @param channel Channel 0 to ADC_CHANNELS - 1.
+         * @param length Window length in decimated values, 1 to VECTOR_SIZE.
+         * @param hop Number of new decimated values between two windows, at least 1.
+         * @return False if a parameter is out of range.
+         */
+        bool set_window(int channel, unsigned int length, unsigned int hop);
+
+#ifdef COOPERATIVE_SCHEDULING
+        /**
+         * @brief Resumes the converters parked on a full reading queue.
+         *
+         * A converter whose block finds the ReadingQueue full is parked instead of
+         * posting its block again, its conversions wait in the ring. The consumer of
+         * the queue calls this on the EventLoop after it has taken a window.
+         */
+        static void resume_parked(void);
+#endif
+
+        /**
+         * @brief Returns the timing statistics of every channel for the current interval.
+         *
+         * The acquisition thread only counts, an interval lasts from one call
+         * with new_interval to the next.
+         * @param statistics Receives the statistics of channel 0 to ADC_CHANNELS - 1.
+         * @param new_interval Starts a new interval after reading.
+         */
+        void get_acquisition_statistics(AcquisitionStats::Statistics (&statistics)[ADC_CHANNELS],
+                                        bool new_interval = false);
+
+    private:
+
+        /// Number of registers of the AD7124 (status to GAIN_7).
+        static const int REGISTER_COUNT = 0x39;
+
+        /// Largest batch of register accesses: channel, configuration and filter registers, the
+        /// temperature sensor's channel, configuration and filter registers and the control register.
+        static const std::size_t REGISTER_BATCH_SIZE = 3 * ADC_CHANNELS + 4;
+
+        /// A register and the value it should hold.
+        struct RegisterValue {
+            uint8_t  address;
+            uint32_t value;
+        };
+
+        AD7124Bus&  m_bus;              ///< SPI, DOUT/RDY, CS and SYNC of the AD7124.
+        uint8_t     m_device;           ///< Number of the converter.
+
+        // Copy of the register map as last written or read back. Only differing registers are written.
+        uint32_t    m_shadow[REGISTER_COUNT];
+        uint64_t    m_shadow_known;     ///< Bit n is set while register n is known, unknown registers are always written.
+
+        // Frames and registers of a batch, kept off the stack of the thread configuring or calibrating.
+        // Register accesses are serialised, the DRDY thread runs them once acquisition has started.
+        char          m_register_tx[REGISTER_BATCH_SIZE * 4];
+        char          m_register_rx[REGISTER_BATCH_SIZE * 4];
+        RegisterValue m_register_written[REGISTER_BATCH_SIZE];   ///< Registers of a batch to verify.
+        RegisterValue m_register_read_back[REGISTER_BATCH_SIZE]; ///< Their values read back.
+
+#ifdef COOPERATIVE_SCHEDULING
+        std::atomic<bool> m_block_posted; ///< Set while run_block() is pending on the EventLoop.
+        std::atomic<bool> m_parked;       ///< Set while run_block() waits for a slot of the reading queue.
+        static AD7124* s_converters[ADC_DEVICES]; ///< Every converter by number, for resume_parked().
+#else
+        EventQueue  m_drdy_queue;       ///< Runs the SPI reads requested by the DRDY interrupt.
+        Thread      m_drdy_thread;      ///< High priority thread dispatching m_drdy_queue.
+        EventFlags  m_block_ready;      ///< Set when the ring holds at least one block of conversions.
+#endif
+        uint32_t    m_drdy_timestamp;   ///< Timestamp of the conversion being read.
+
+        // Filled by the DRDY handler, drained by the acquisition thread.
+        SpscRing<RawConversion, ACQUISITION_RING_SIZE> m_conversions;
+
+        Configuration m_configuration;          ///< Configuration written last.
+        std::atomic<bool> m_acquisition_running; ///< Set once the DRDY thread dispatches reads, read by configure() and calibrate().
+        std::atomic<bool> m_acquisition_paused; ///< Keeps the DRDY interrupt masked during configuration.
+        std::atomic<bool> m_conversion_in_flight; ///< Set while a conversion read checks the pause or runs.
+        std::atomic<bool> m_read_requested;     ///< Set from the request of a read until it runs, or completes if asynchronous.
+        std::atomic<bool> m_async_reads;        ///< Cleared once the bus refused an asynchronous transfer.
+
+        // Timing of the conversions per channel, updated by the acquisition thread.
+        AcquisitionStats m_statistics[ADC_CHANNELS];
+        Mutex       m_statistics_mutex;
+        std::atomic<uint32_t> m_expected_gap_us; ///< Gap between conversions of a channel at the configured rate.
+
+        /// Window length and hop of a channel.
+        struct WindowSettings {
+            uint16_t length;
+            uint16_t hop;
+        };
+
+        // Written by set_window(), applied by the acquisition thread.
+        WindowSettings m_window_settings[ADC_CHANNELS];
+        Mutex       m_window_mutex;
+        std::atomic<bool> m_window_settings_changed;
+
+        // One conversion is 24 data bits followed by the status byte, read in a single transaction.
+        char        m_conversion_tx[4];
+        char        m_conversion_rx[4];
+
+        // Windows and blocks of the acquisition thread. Pushing a value into a window does not move the others.
+        ByteWindow    m_byte_inputs[ADC_CHANNELS];
+        int32_t       m_filtered[ADC_CHANNELS][ACQUISITION_BLOCK_SIZE];
+        RawConversion m_batch[ACQUISITION_BLOCK_SIZE];
+
+        // Filters of the acquisition thread, impulsive artefacts are removed before they are smeared over a window value.
+        std::vector<MedianFilter> m_medians;
+        std::vector<Decimator>    m_decimators;
+        uint16_t      m_new_values[ADC_CHANNELS]; ///< Values added to each window since it was sent last.
+        uint16_t      m_hops[ADC_CHANNELS];       ///< Values after which a window is due.
+        uint32_t      m_reported_overflows;       ///< Ring overflows already warned about.
+        bool          m_held_back;                ///< Set while due windows wait a block for an almost due one.
+
+        /**
+         * @brief Initializes the AD7124 ADC and enables channels 0 to ADC_CHANNELS - 1.
+         */
+        void init(void);
  
         /**
          * @brief Resets the AD7124 device.
@@ -70,40 +330,136 @@ class AD7124: private mbed::NonCopyable<AD7124>{
         char status(void);
 
         /**
-         * @brief Configures the channel register.
-         * @param RW Read (R) or Write (W) operation indicator.
+         * @brief Sets the shadow registers to the power-on values of the device.
+         */
+        void reset_shadow(void);
+
+        /**
+         * @brief Size of a register in bytes, the data register without the status byte.
+         */
+        static int register_size(uint8_t address);
+
+        /**
+         * @brief Writes the registers that differ from the shadow in one SPI transaction.
+         * @param registers Registers and their new values.
+         * @param count Number of registers.
+         * @param verify Reads the written registers back in a second transaction.
+         * @return False if a register read back differently. The shadow then holds the value read.
+         */
+        bool write_registers(const RegisterValue* registers, std::size_t count, bool verify);
+
+        /**
+         * @brief Reads registers in one SPI transaction and updates the shadow.
+         * @param registers Addresses to read, receive the values.
+         */
+        void read_registers(RegisterValue* registers, std::size_t count);
+
+        /**
+         * @brief Polls DOUT/RDY until it is low.
+         * @return False on timeout.
+         */
+        bool wait_for_drdy(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Leaves continuous read mode so that registers can be accessed.
+         * @return False if no conversion became ready within the timeout.
+         */
+        bool exit_continuous_read(void);
+
+        bool pause_acquisition(void);
+        void resume_acquisition(void);
+
+        /**
+         * @brief Die temperature in degrees Celsius from the internal sensor, NAN on timeout.
+         */
+        float measure_temperature(void);
+
+        /**
+         * @brief Runs the internal calibrations of one setup.
+         */
+        bool calibrate_setup(int setup);
+
+        /**
+         * @brief Restores or runs the calibration. Runs on the DRDY thread while acquiring.
+         */
+        bool run_calibration(CalibrationStore& store, float temperature_delta, bool force);
+
+        /**
+         * @brief Writes, optionally verifies and activates a configuration. Runs on the DRDY thread while acquiring.
          */
-        void channel_reg(char RW);
+        bool apply_configuration(const Configuration& configuration, bool verify);
 
         /**
-         * @brief Configures a register by address.
-         * @param address Register address to configure.
-         * @param RW Read (R) or Write (W) operation indicator.
+         * @brief Settling time of a setup in seconds, i.e. the time of one conversion after a channel change.
          */
-        void config_reg(uint8_t address, char RW);
+        float get_settling_time(int setup) const;
 
         /**
-         * @brief Configures the filter register.
-         * @param filt Filter value to set.
-         * @param RW Read (R) or Write (W) operation indicator.
+         * @brief Register values derived from the configuration.
          */
-        void filter_reg(uint8_t filt, char RW);
+        uint16_t channel_register_value(int channel) const;
+        uint32_t filter_register_value(const SetupConfig& setup) const;
+        uint16_t config_register_value(const SetupConfig& setup) const;
+        uint16_t control_register_value(PowerMode power_mode) const;
 
         /**
-         * @brief Configures the control register.
-         * @param RW Read (R) or Write (W) operation indicator.
+         * @brief DRDY falling edge handler. Masks the interrupt and defers the read.
          */
-        void ctrl_reg(char RW);
+        void drdy_isr(void);
+
+        /**
+         * @brief Starts the read of the conversion at most once, asynchronously or on the DRDY thread.
+         */
+        void request_read(void);
+
+        /**
+         * @brief Queues the asynchronous SPI transaction that reads one conversion.
+         * @return False if the bus refused it, the read is then left to read_conversion().
+         */
+        bool start_conversion_read(void);
+
+        /**
+         * @brief Reads one conversion in a blocking SPI transaction on the DRDY thread.
+         */
+        void read_conversion(void);
+
+        /**
+         * @brief Pushes a conversion read by read_conversion() into the ring.
+         * @param event SPI event flags of the finished asynchronous transaction, 0 otherwise.
+         */
+        void conversion_complete(int event);
+
+        /**
+         * @brief Creates the filters of every channel and starts interrupt driven acquisition.
+         */
+        void start_acquisition(unsigned int decimation_ratio, unsigned int median_window, int32_t spike_threshold);
+
+        /**
+         * @brief Filters and decimates at most one block of buffered conversions and sends
+         * the windows that are due.
+         * @return False if the ring was empty.
+         */
+        bool process_block(void);
+
+#ifdef COOPERATIVE_SCHEDULING
+        /**
+         * @brief Posts run_block() to the EventLoop unless it is pending or parked. May run in interrupt context.
+         */
+        void schedule_block(void);
+
+        /**
+         * @brief Handler of the EventLoop processing one block, in place of the acquisition thread.
+         */
+        void run_block(void);
+#endif
 
         /**
          * @brief Sends data to the main thread for processing.
-         * @param byte_inputs_channel_0 Byte array inputs for channel 0.
-         * @param byte_inputs_channel_1 Byte array inputs for channel 1.
+         * @param byte_inputs Window of every channel, copied once into the mail.
+         * @param new_values Values added to each window since it was sent last, 0 if it is not due.
          */
-        void send_data_to_main_thread(
-            std::vector<std::array<uint8_t, 3>> byte_inputs_channel_0,
-            std::vector<std::array<uint8_t, 3>> byte_inputs_channel_1
-        );
+        void send_data_to_main_thread(const ByteWindow (&byte_inputs)[ADC_CHANNELS],
+                                      const uint16_t (&new_values)[ADC_CHANNELS]);
 
 };
 #endif
@@ -0,0 +1,65 @@
+#ifndef AD7124_BUS_H
+#define AD7124_BUS_H
+
+#include "mbed.h"
+#include <cstdint>
+
+/**
+ * @class AD7124Bus
+ * @brief Signals the AD7124 driver uses: SPI, the DOUT/RDY line, CS and SYNC.
+ *
+ * MbedAD7124Bus maps the interface onto the pins of the board and
+ * SimulatedAD7124 onto a software model of the converter, so the driver and
+ * everything behind it can run without hardware.
+ */
+class AD7124Bus {
+    public:
+        /// Event passed to the completion callback of a failed asynchronous transfer.
+        static const int TRANSFER_ERROR = 1;
+
+        virtual ~AD7124Bus(void) {}
+
+        /**
+         * @brief Exchanges one byte.
+         * @param value Byte sent on MOSI.
+         * @return Byte received on MISO.
+         */
+        virtual int write(int value) = 0;
+
+        /**
+         * @brief Exchanges length bytes in one transaction.
+         */
+        virtual void transfer(const char* tx, char* rx, int length) = 0;
+
+        /**
+         * @brief Starts or queues an asynchronous transaction (e.g. by DMA). May be called
+         * in interrupt context; the buffers must stay valid until done is called.
+         * @param done Called with 0 or TRANSFER_ERROR when the transaction has finished,
+         *        possibly in interrupt context.
+         * @return 0 if the transaction was started or queued. Otherwise the caller falls back to transfer().
+         */
+        virtual int transfer_async(const char* tx, char* rx, int length, const Callback<void(int)>& done) = 0;
+
+        /**
+         * @brief Returns the level of DOUT/RDY, 0 while a conversion is ready.
+         */
+        virtual int read_drdy(void) = 0;
+
+        /**
+         * @brief Attaches the handler of the falling DOUT/RDY edge.
+         */
+        virtual void attach_drdy(const Callback<void()>& handler) = 0;
+
+        virtual void enable_drdy_irq(void) = 0;
+        virtual void disable_drdy_irq(void) = 0;
+
+        virtual void set_cs(int level) = 0;
+        virtual void set_sync(int level) = 0;
+
+        /**
+         * @brief Returns the time base of the conversion timestamps in microseconds.
+         */
+        virtual uint32_t get_time_us(void) = 0;
+};
+
+#endif // AD7124_BUS_H
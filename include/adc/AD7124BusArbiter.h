@@ -0,0 +1,161 @@
+#ifndef AD7124_BUS_ARBITER_H
+#define AD7124_BUS_ARBITER_H
+
+#include "mbed.h"
+#include <cstdint>
+
+#include "adc/AD7124Bus.h"
+#include "adc/MbedAD7124Bus.h"
+#include "utils/constants.h"
+
+/**
+ * @class AD7124BusArbiter
+ * @brief Shares one SPI bus between ADC_DEVICES converters with independent chip selects.
+ *
+ * Every converter has its own bus (on the board an MbedAD7124Bus, which adds its
+ * CS pin to the SPI, DRDY and SYNC lines the arbiter owns, or a SimulatedAD7124)
+ * and its own AD7124 driver, which talks to a port of the arbiter instead. The arbiter owns the chip selects: a transaction
+ * selects its device, and transactions that find the bus busy wait in a request
+ * queue in the order they were requested, which for conversion reads is the order
+ * of the DRDY edges. A request holds the tx and rx buffers and, if asynchronous,
+ * the completion callback: it returns at once and is started from the completion
+ * of the transaction before it, possibly in interrupt context. Blocking requests
+ * put their thread to sleep until they are granted the bus.
+ *
+ * A deselected AD7124 three-states DOUT/RDY, so only the selected device can
+ * signal DRDY. While the bus is idle, the arbiter keeps the device whose DRDY
+ * interrupt is armed and whose conversion was read longest ago selected and
+ * listens to its edge. After every transaction it selects the next device in
+ * that order and reads its level first, so a conversion that completed while
+ * another device owned the bus is read right away. On the board all DRDY inputs
+ * are the shared MISO pin, so an edge may arrive through the bus of any device;
+ * it always belongs to the device being listened to.
+ */
+class AD7124BusArbiter: private mbed::NonCopyable<AD7124BusArbiter> {
+    public:
+        /**
+         * @brief Creates the arbiter and deselects every device.
+         * @param devices Bus of each converter, outliving the arbiter.
+         */
+        explicit AD7124BusArbiter(AD7124Bus* const (&devices)[ADC_DEVICES]);
+
+        /**
+         * @brief Creates the arbiter of the converters on the board's SPI bus and deselects every device.
+         * The arbiter creates the shared lines once and the bus of every device on them.
+         * @param spi_frequency The SPI clock frequency in Hz.
+         * @param cs Chip select of each of the ADC_DEVICES converters.
+         */
+        AD7124BusArbiter(int spi_frequency, const PinName* cs);
+
+        ~AD7124BusArbiter(void);
+
+        /**
+         * @brief Returns the bus the driver of a device uses.
+         * @param device Device 0 to ADC_DEVICES - 1.
+         */
+        AD7124Bus& port(int device);
+
+    private:
+        /// AD7124Bus of one device, forwarding to the arbiter. CS is driven by the arbiter.
+        class Port: public AD7124Bus {
+            public:
+                int write(int value) override;
+                void transfer(const char* tx, char* rx, int length) override;
+                int transfer_async(const char* tx, char* rx, int length, const Callback<void(int)>& done) override;
+                int read_drdy(void) override;
+                void attach_drdy(const Callback<void()>& handler) override;
+                void enable_drdy_irq(void) override;
+                void disable_drdy_irq(void) override;
+                void set_cs(int level) override;
+                void set_sync(int level) override;
+                uint32_t get_time_us(void) override;
+
+            private:
+                friend class AD7124BusArbiter;
+
+                AD7124BusArbiter* m_arbiter;
+                int               m_device;
+
+                void transfer_complete(int event);
+        };
+
+        static const int NONE = -1;
+
+        /// Transaction of a device, queued while the bus is busy.
+        struct Request {
+            const char* tx;
+            char*       rx;
+            int         length;
+            bool        async;      ///< Completed by a callback instead of a waiting thread.
+        };
+
+        MbedAD7124Bus::Lines* m_lines;  ///< Lines of the board's buses, nullptr if the buses were passed in.
+        AD7124Bus*  m_devices[ADC_DEVICES];
+        Port        m_ports[ADC_DEVICES];
+
+        int         m_owner;        ///< Device running a transaction, NONE while the bus is idle.
+        int         m_selected;     ///< Device whose CS is low, NONE if all are high.
+        int         m_listening;    ///< Selected device whose DRDY interrupt is enabled, NONE if none.
+
+        // Devices waiting for the bus, oldest request first. A driver runs one transaction at a time.
+        Request     m_requests[ADC_DEVICES];
+        int         m_waiting[ADC_DEVICES];
+        int         m_waiting_head;
+        int         m_waiting_count;
+        Semaphore   m_granted[ADC_DEVICES];
+
+        bool        m_armed[ADC_DEVICES];       ///< The driver of the device has enabled its DRDY interrupt.
+        bool        m_async[ADC_DEVICES];       ///< Cleared once the bus of the device refused an asynchronous transfer.
+        uint32_t    m_serviced[ADC_DEVICES];    ///< Sequence number of the last transaction of each device.
+        uint32_t    m_sequence;
+
+        Callback<void()>    m_drdy_handlers[ADC_DEVICES];
+        Callback<void(int)> m_transfer_done[ADC_DEVICES];
+
+        /**
+         * @brief Takes over the buses and deselects every device.
+         */
+        void init(AD7124Bus* const (&devices)[ADC_DEVICES]);
+
+        /**
+         * @brief Waits until the device owns the bus and selects it.
+         */
+        void acquire(int device);
+
+        /**
+         * @brief Starts an asynchronous transaction, or queues it while the bus is busy.
+         * @return 0 if started or queued, -1 if the bus of the device cannot transfer asynchronously.
+         */
+        int submit(int device, const char* tx, char* rx, int length, const Callback<void(int)>& done);
+
+        /**
+         * @brief Starts the asynchronous request of the device owning the bus.
+         */
+        bool start(int device);
+
+        /**
+         * @brief Ends the transaction of the device and hands the bus to the next request
+         * queued, or starts listening. May run in interrupt context.
+         */
+        void release(int device);
+
+        /**
+         * @brief Selects the armed device read longest ago and listens to its DRDY.
+         * Called with the bus idle, inside a critical section.
+         */
+        void listen(void);
+
+        void stop_listening(void);
+        void select(int device);
+
+        /**
+         * @brief DRDY edge of the device being listened to.
+         */
+        void drdy_edge(void);
+
+        int read_drdy(int device);
+        void enable_drdy_irq(int device);
+        void disable_drdy_irq(int device);
+};
+
+#endif // AD7124_BUS_ARBITER_H
@@ -0,0 +1,71 @@
+#ifndef ACQUISITION_STATS_H
+#define ACQUISITION_STATS_H
+
+#include <cstdint>
+
+/**
+ * @class AcquisitionStats
+ * @brief Streaming timing statistics of the conversions of one channel.
+ *
+ * Fed with the DRDY timestamps of consecutive conversions, it keeps the number
+ * of conversions and the minimum, maximum and mean gap between them for the
+ * current interval, and estimates the conversions that were lost: a gap of n
+ * expected intervals (rounded) means n - 1 missed DRDY edges or dropped
+ * conversions. Timestamps are free-running microseconds, their wrap-around
+ * is handled by unsigned arithmetic.
+ */
+class AcquisitionStats {
+    public:
+        /// Statistics of one interval, plus totals since start.
+        struct Statistics {
+            uint32_t count;             ///< Conversions in the interval.
+            uint32_t min_gap_us;        ///< Smallest gap between two conversions, 0 if count < 2.
+            uint32_t max_gap_us;
+            float    mean_gap_us;
+            uint32_t missed;            ///< Estimated conversions lost in the interval.
+            uint32_t expected_gap_us;   ///< Gap at the configured channel data rate.
+            uint32_t total_count;
+            uint32_t total_missed;
+        };
+
+        AcquisitionStats(void);
+
+        /**
+         * @brief Sets the gap between conversions at the configured data rate, 0 disables the missed estimate.
+         */
+        void set_expected_gap(uint32_t expected_gap_us);
+
+        /**
+         * @brief Adds a conversion in O(1).
+         * @param timestamp DRDY timestamp in microseconds.
+         */
+        void update(uint32_t timestamp);
+
+        /**
+         * @brief Returns the statistics of the current interval.
+         */
+        Statistics get(void) const;
+
+        /**
+         * @brief Starts a new interval. The totals and the last timestamp are kept,
+         * so the first gap of the new interval is measured across the boundary.
+         */
+        void reset_interval(void);
+
+    private:
+        bool     m_has_timestamp;
+        uint32_t m_last_timestamp;
+        uint32_t m_expected_gap_us;
+
+        uint32_t m_count;
+        uint32_t m_gap_count;
+        uint32_t m_min_gap_us;
+        uint32_t m_max_gap_us;
+        uint64_t m_gap_sum_us;
+        uint32_t m_missed;
+
+        uint32_t m_total_count;
+        uint32_t m_total_missed;
+};
+
+#endif // ACQUISITION_STATS_H
@@ -0,0 +1,61 @@
+#ifndef CALIBRATION_STORE_H
+#define CALIBRATION_STORE_H
+
+#include "mbed.h"
+#include "blockdevice/BlockDevice.h"
+#include <cstdint>
+
+/**
+ * @class CalibrationStore
+ * @brief Persists the AD7124 offset and gain coefficients of every setup.
+ *
+ * One record is kept at the start of a block device, a FlashIAPBlockDevice
+ * behind the application on the node or a FileBlockDevice on a host. The
+ * record carries the configuration and die temperature it was calibrated at,
+ * so the driver can tell whether it still applies, and a checksum, so an
+ * erased or torn record is never restored.
+ */
+class CalibrationStore: private mbed::NonCopyable<CalibrationStore> {
+    public:
+        /// Maximum number of setups of the AD7124.
+        static const int SETUPS = 8;
+
+        /// Calibration of all setups and the conditions it was taken under.
+        struct Record {
+            float    temperature;       ///< Die temperature at calibration in degrees Celsius.
+            uint16_t control;           ///< ADC control register (power mode) at calibration.
+            uint16_t setups;            ///< Number of valid setups.
+            uint16_t config[SETUPS];    ///< Configuration register (gain, reference, buffers) per setup.
+            uint32_t filter[SETUPS];    ///< Filter register per setup.
+            uint32_t offset[SETUPS];    ///< Offset register per setup.
+            uint32_t gain[SETUPS];      ///< Gain register per setup.
+        };
+
+        /**
+         * @brief Creates a store on a block device. The device is initialized on every access.
+         */
+        explicit CalibrationStore(BlockDevice& device);
+
+        /**
+         * @brief Reads the record.
+         * @return False if the device holds no valid record.
+         */
+        bool load(Record& record);
+
+        /**
+         * @brief Erases the first erase unit and programs the record.
+         * @return False if the device failed.
+         */
+        bool save(const Record& record);
+
+    private:
+        /// Record with header and checksum, padded to the program size of the device.
+        static const std::size_t BUFFER_SIZE = 256;
+
+        BlockDevice& m_device;
+        uint8_t      m_buffer[BUFFER_SIZE];
+
+        static uint32_t checksum(const uint8_t* data, std::size_t size);
+};
+
+#endif // CALIBRATION_STORE_H
@@ -0,0 +1,78 @@
+#ifndef MBED_AD7124_BUS_H
+#define MBED_AD7124_BUS_H
+
+#include "mbed.h"
+#include "adc/AD7124Bus.h"
+#include "utils/constants.h"
+
+/**
+ * @class MbedAD7124Bus
+ * @brief AD7124Bus on the SPI peripheral and GPIOs of the board.
+ *
+ * DOUT/RDY shares its pin with MISO, so the same pin is used for SPI and
+ * for the DRDY interrupt. The interrupt stays masked until it is enabled.
+ * A running Timer holds the deep sleep lock, so in LOW_POWER_MODE the
+ * timestamps come from a LowPowerTimer at the resolution of the low power ticker.
+ *
+ * Converters on one SPI bus share its Lines and differ only in their chip
+ * select. The DRDY methods of every bus act on the one shared interrupt, which
+ * the AD7124BusArbiter hands from device to device.
+ */
+class MbedAD7124Bus: public AD7124Bus, private mbed::NonCopyable<MbedAD7124Bus> {
+    public:
+        /**
+         * @class Lines
+         * @brief SPI, DOUT/RDY and SYNC of one SPI bus, created once for all its converters.
+         *
+         * An STM32 EXTI line serves one handler per pin number, so a second
+         * InterruptIn on MISO would take over the handler of the first.
+         */
+        class Lines: private mbed::NonCopyable<Lines> {
+            public:
+                /**
+                 * @brief Creates the lines. The defaults are the pins of the Nucleo-WB55RG node.
+                 * @param spi_frequency The SPI clock frequency in Hz.
+                 */
+                Lines(int spi_frequency, PinName mosi = PA_7, PinName miso = PA_6, PinName sclk = PA_5,
+                      PinName sync = PA_1);
+
+            private:
+                friend class MbedAD7124Bus;
+
+                SPI         m_spi;
+                InterruptIn m_drdy;             ///< DOUT/RDY line, falls when a conversion is ready.
+                DigitalOut  m_sync;
+#ifdef LOW_POWER_MODE
+                LowPowerTimer m_timestamp_timer;  ///< Time base of the conversion timestamps.
+#else
+                Timer       m_timestamp_timer;  ///< Time base of the conversion timestamps.
+#endif
+
+                Callback<void(int)> m_transfer_done; ///< Of the one transfer the bus runs at a time.
+
+                void transfer_complete(int event);
+        };
+
+        /**
+         * @brief Creates the bus of the converter selected by cs.
+         * @param lines Lines of the SPI bus, outliving the bus.
+         */
+        explicit MbedAD7124Bus(Lines& lines, PinName cs = PA_4);
+
+        int write(int value) override;
+        void transfer(const char* tx, char* rx, int length) override;
+        int transfer_async(const char* tx, char* rx, int length, const Callback<void(int)>& done) override;
+        int read_drdy(void) override;
+        void attach_drdy(const Callback<void()>& handler) override;
+        void enable_drdy_irq(void) override;
+        void disable_drdy_irq(void) override;
+        void set_cs(int level) override;
+        void set_sync(int level) override;
+        uint32_t get_time_us(void) override;
+
+    private:
+        Lines&      m_lines;
+        DigitalOut  m_cs;
+};
+
+#endif // MBED_AD7124_BUS_H
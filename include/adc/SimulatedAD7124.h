@@ -0,0 +1,142 @@
+#ifndef SIMULATED_AD7124_H
+#define SIMULATED_AD7124_H
+
+#include "mbed.h"
+#include <cstddef>
+#include <cstdint>
+
+#include "adc/AD7124Bus.h"
+
+/**
+ * @class SimulatedAD7124
+ * @brief Software model of an AD7124-8 behind the AD7124Bus interface.
+ *
+ * The model decodes the SPI protocol (communications register, register
+ * reads and writes, reset by 64 ones, continuous read mode with the appended
+ * status byte and its exit by 0x42), keeps the register map and runs the
+ * channel sequencer. Each conversion takes the settling time derived from the
+ * filter, FS word and power mode of the channel's setup, and DOUT/RDY falls
+ * when it completes. Conversion results come from a trace: a synthetic signal
+ * by default, a recorded one, or any callback.
+ *
+ * Time is simulated. With a speedup of N the conversions are scheduled N times
+ * faster than real time by a Timeout. With a speedup of 0 the next conversion
+ * completes as soon as the driver waits for it, so the whole acquisition path
+ * runs as fast as it can consume conversions.
+ *
+ * Asynchronous transfers run on a worker thread of the model, standing in for
+ * the DMA of the board: transfer_async() returns at once and the completion
+ * callback is called from the worker.
+ */
+class SimulatedAD7124: public AD7124Bus, private mbed::NonCopyable<SimulatedAD7124> {
+    public:
+        /// Returns the signed 24-bit code of a channel at a simulated time.
+        typedef Callback<int32_t(int channel, uint64_t time_us)> trace_t;
+
+        /**
+         * @brief Creates the model in its power-on state, fed by synthetic_trace().
+         * @param speedup Simulated time per real time, 0 to run as fast as conversions are read.
+         */
+        explicit SimulatedAD7124(unsigned int speedup = 0);
+
+        /**
+         * @brief Replaces the trace.
+         */
+        void set_trace(const trace_t& trace);
+
+        /**
+         * @brief Feeds recorded codes, repeated at the end.
+         * @param codes Signed 24-bit codes interleaved by channel (ch0, ch1, ..., ch0, ...).
+         *        The buffer must outlive the model.
+         * @param count Number of codes.
+         * @param channels Number of interleaved channels.
+         */
+        void set_recorded_trace(const int32_t* codes, std::size_t count, int channels);
+
+        /**
+         * @brief Default trace: a slow sine per channel with noise and occasional spikes.
+         */
+        static int32_t synthetic_trace(int channel, uint64_t time_us);
+
+        uint64_t get_simulated_time_us(void) const;
+
+        /**
+         * @brief Returns the number of completed conversions.
+         */
+        uint32_t get_conversion_count(void) const;
+
+        /**
+         * @brief Returns the number of conversions overwritten before they were read.
+         */
+        uint32_t get_missed_count(void) const;
+
+        int write(int value) override;
+        void transfer(const char* tx, char* rx, int length) override;
+        int transfer_async(const char* tx, char* rx, int length, const Callback<void(int)>& done) override;
+        int read_drdy(void) override;
+        void attach_drdy(const Callback<void()>& handler) override;
+        void enable_drdy_irq(void) override;
+        void disable_drdy_irq(void) override;
+        void set_cs(int level) override;
+        void set_sync(int level) override;
+        uint32_t get_time_us(void) override;
+
+    private:
+        static const int REGISTER_COUNT = 0x39;
+
+        enum class SpiState { Command, Read, Write };
+
+        uint32_t m_registers[REGISTER_COUNT];
+
+        SpiState m_spi_state;
+        uint8_t  m_address;         ///< Register of the current read or write.
+        int      m_bytes_left;      ///< Bytes left in the current read or write.
+        uint32_t m_shift;           ///< Value being shifted out or in.
+        int      m_ones;            ///< Consecutive 0xFF bytes, 8 reset the part.
+
+        bool     m_converting;      ///< The sequencer or a calibration is running.
+        bool     m_calibrating;
+        bool     m_ready;           ///< DOUT/RDY low, the data register holds an unread result.
+        int      m_channel;         ///< Channel being converted.
+        int      m_data_channel;    ///< Channel of the result in the data register.
+        uint32_t m_data;            ///< Data register.
+        bool     m_first_conversion;
+        uint64_t m_time_us;         ///< Simulated time of the last completed conversion.
+        uint32_t m_conversion_count;
+        uint32_t m_missed_count;
+
+        unsigned int m_speedup;
+        Timeout  m_timeout;
+
+        Callback<void()> m_drdy_handler;
+        bool     m_irq_enabled;
+
+        EventQueue m_worker_queue;      ///< Asynchronous transfers, at most one at a time.
+        Thread   m_worker;
+        const char* m_async_tx;
+        char*    m_async_rx;
+        int      m_async_length;
+        Callback<void(int)> m_async_done;
+
+        trace_t  m_trace;
+        const int32_t* m_recorded_codes;
+        std::size_t m_recorded_count;
+        int      m_recorded_channels;
+        std::size_t m_recorded_index[16];
+
+        void reset_registers(void);
+        int register_size(uint8_t address) const;
+        uint32_t read_register_value(uint8_t address);
+        void write_register_value(uint8_t address, uint32_t value);
+        void start_mode(void);
+        int next_enabled_channel(int channel) const;
+        uint64_t conversion_time_us(int channel) const;
+        void schedule_conversion(void);
+        bool complete_conversion(void);
+        void timeout_event(void);
+        void fire_drdy(void);
+        void run_async_transfer(void);
+        int32_t recorded_sample(int channel, uint64_t time_us);
+};
+
+#endif // SIMULATED_AD7124_H
@@ -0,0 +1,48 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "mbed.h"
+
+#include "utils/constants.h"
+
+/**
+ * @class EventLoop
+ * @brief The single event queue of the cooperative scheduling mode (COOPERATIVE_SCHEDULING).
+ *
+ * Acquisition blocks, conversion reads, inference jobs and serial mails are posted
+ * as handlers and run to completion, in order, on the thread that calls dispatch(),
+ * so no stage needs a thread and stack of its own. A handler never waits for another
+ * stage: it returns and the stage it waits for posts the next handler.
+ */
+class EventLoop {
+public:
+
+    // Static method to access the single instance
+    static EventLoop& getInstance();
+
+    /**
+     * @brief Queues a handler. May be called from any thread or interrupt.
+     * @return False if the queue is full, the handler is then not run.
+     */
+    bool post(const Callback<void()>& handler);
+
+    /**
+     * @brief Runs the handlers on the calling thread, forever.
+     */
+    void dispatch(void);
+
+private:
+    EventQueue m_queue;
+
+    // Private constructor to prevent direct instantiation
+    EventLoop(void);
+
+    // Private destructor (optional)
+    ~EventLoop();
+
+    // Deleted copy constructor and assignment operator to prevent copies
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+};
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,236 @@
+#ifndef PIPELINE_EDGE_H
+#define PIPELINE_EDGE_H
+
+#include "mbed.h"
+#include <cstddef>
+#include <cstdint>
+
+/// What an edge does with a new item while it is full.
+enum class BackpressurePolicy {
+    Block,          ///< The producer sleeps until the consumer takes an item.
+    DropOldest,     ///< The oldest queued item is dropped to make room.
+    DropNewest,     ///< The new item is dropped.
+    CoalesceLatest  ///< The new item replaces every queued item it supersedes, then the oldest is dropped if still full.
+};
+
+/**
+ * @class PipelineEdge
+ * @brief Bounded queue of item pointers between two pipeline stages, with a backpressure policy.
+ *
+ * The producer stage puts items and the consumer stage sleeps in get() until one
+ * arrives. Only Block lets a slow consumer stall the producer, the other policies
+ * drop items instead. A dropped item is handed to the release callback (e.g. back
+ * to its pool), outside the lock, while the condition variables are notified under
+ * it, as Mbed requires. The coalesce callback decides whether a new item
+ * supersedes a queued one and may fold the queued item's state into it; without
+ * one, the new item supersedes all. A consumer without a thread of its own sets a
+ * notify callback, which runs after every queued item, and takes items with try_get().
+ *
+ * Every edge counts the items put, dropped and blocked and its highest depth, so
+ * a stage that cannot keep up shows in the statistics rather than as a silent stall.
+ *
+ * @tparam T Item type, passed by pointer. The reference passes with the pointer.
+ * @tparam Depth Number of queued items.
+ */
+template <typename T, std::size_t Depth>
+class PipelineEdge: private mbed::NonCopyable<PipelineEdge<T, Depth>> {
+    static_assert(Depth >= 1, "An edge needs room for one item");
+
+    public:
+        /// Counters of an edge since they were last reset.
+        struct Statistics {
+            uint32_t depth;         ///< Items queued now.
+            uint32_t max_depth;     ///< Highest number of queued items.
+            uint32_t put;           ///< Items offered by the producer.
+            uint32_t dropped;       ///< Items dropped or coalesced away.
+            uint32_t blocked;       ///< Puts that waited for room.
+        };
+
+        /// Takes back a dropped item.
+        typedef Callback<void(T*)> release_t;
+
+        /// Returns true if latest supersedes queued. May fold the state of queued into latest.
+        typedef Callback<bool(T* latest, T* queued)> coalesce_t;
+
+        /// Tells the consumer that an item was queued.
+        typedef Callback<void()> notify_t;
+
+        /**
+         * @brief Creates an empty edge.
+         * @param name Name of the edge in the statistics.
+         */
+        PipelineEdge(const char* name, BackpressurePolicy policy):
+            m_name(name), m_policy(policy), m_not_empty(m_mutex), m_not_full(m_mutex),
+            m_head(0), m_count(0), m_statistics{0, 0, 0, 0, 0} {}
+
+        const char* get_name(void) const {
+            return m_name;
+        }
+
+        void set_policy(BackpressurePolicy policy) {
+            m_mutex.lock();
+            m_policy = policy;
+            m_not_full.notify_all(); // Blocked producers apply the new policy
+            m_mutex.unlock();
+        }
+
+        void set_release(const release_t& release) {
+            m_release = release;
+        }
+
+        void set_coalesce(const coalesce_t& coalesce) {
+            m_coalesce = coalesce;
+        }
+
+        void set_notify(const notify_t& notify) {
+            m_notify = notify;
+        }
+
+        /**
+         * @brief Queues an item according to the policy. Producer side.
+         * @return False if the item itself was dropped.
+         */
+        bool put(T* item) {
+            // At most the whole queue is dropped, and the new item
+            T* dropped[Depth + 1];
+            std::size_t dropped_count = 0;
+            bool queued = true;
+
+            m_mutex.lock();
+            m_statistics.put++;
+            if (m_policy == BackpressurePolicy::CoalesceLatest) {
+                dropped_count = coalesce(item, dropped);
+            }
+            bool waited = false;
+            while (m_count == Depth) {
+                if (m_policy == BackpressurePolicy::Block) {
+                    if (!waited) {
+                        m_statistics.blocked++;
+                        waited = true;
+                    }
+                    m_not_full.wait();
+                } else if (m_policy == BackpressurePolicy::DropNewest) {
+                    dropped[dropped_count++] = item;
+                    queued = false;
+                    break;
+                } else {
+                    dropped[dropped_count++] = pop();
+                }
+            }
+            if (queued) {
+                m_items[(m_head + m_count) % Depth] = item;
+                m_count++;
+                if (m_count > m_statistics.max_depth) {
+                    m_statistics.max_depth = m_count;
+                }
+                m_not_empty.notify_one();
+            }
+            m_statistics.dropped += dropped_count;
+            m_mutex.unlock();
+
+            if (queued && m_notify) {
+                m_notify();
+            }
+            for (std::size_t i = 0; i < dropped_count; i++) {
+                if (m_release) {
+                    m_release(dropped[i]);
+                }
+            }
+            return queued;
+        }
+
+        /**
+         * @brief Takes the oldest item, sleeping while the edge is empty. Consumer side.
+         */
+        T* get(void) {
+            m_mutex.lock();
+            while (m_count == 0) {
+                m_not_empty.wait();
+            }
+            T* item = pop();
+            m_not_full.notify_one();
+            m_mutex.unlock();
+            return item;
+        }
+
+        /**
+         * @brief Takes the oldest item without waiting. Consumer side.
+         * @return The item, nullptr if the edge is empty.
+         */
+        T* try_get(void) {
+            m_mutex.lock();
+            T* item = m_count > 0 ? pop() : nullptr;
+            if (item != nullptr) {
+                m_not_full.notify_one();
+            }
+            m_mutex.unlock();
+            return item;
+        }
+
+        /**
+         * @brief Returns true if a put() now would wait for room, i.e. the policy is Block and the edge is full.
+         */
+        bool would_block(void) {
+            m_mutex.lock();
+            const bool full = m_policy == BackpressurePolicy::Block && m_count == Depth;
+            m_mutex.unlock();
+            return full;
+        }
+
+        /**
+         * @brief Returns the counters.
+         * @param reset Starts new counters, the highest depth from the current depth.
+         */
+        Statistics get_statistics(bool reset = false) {
+            m_mutex.lock();
+            Statistics statistics = m_statistics;
+            statistics.depth = static_cast<uint32_t>(m_count);
+            if (reset) {
+                m_statistics = {0, static_cast<uint32_t>(m_count), 0, 0, 0};
+            }
+            m_mutex.unlock();
+            return statistics;
+        }
+
+    private:
+        const char*         m_name;
+        BackpressurePolicy  m_policy;
+        release_t           m_release;
+        coalesce_t          m_coalesce;
+        notify_t            m_notify;
+
+        Mutex               m_mutex;        ///< Guards the queue and the counters.
+        ConditionVariable   m_not_empty;
+        ConditionVariable   m_not_full;
+
+        T*                  m_items[Depth];
+        std::size_t         m_head;
+        std::size_t         m_count;
+        Statistics          m_statistics;
+
+        T* pop(void) {
+            T* item = m_items[m_head];
+            m_head = (m_head + 1) % Depth;
+            m_count--;
+            return item;
+        }
+
+        /// Removes the queued items that item supersedes, keeping the order of the others.
+        std::size_t coalesce(T* item, T** dropped) {
+            std::size_t dropped_count = 0;
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < m_count; i++) {
+                T* queued = m_items[(m_head + i) % Depth];
+                if (!m_coalesce || m_coalesce(item, queued)) {
+                    dropped[dropped_count++] = queued;
+                } else {
+                    m_items[(m_head + kept) % Depth] = queued;
+                    kept++;
+                }
+            }
+            m_count = kept;
+            return dropped_count;
+        }
+};
+
+#endif // PIPELINE_EDGE_H
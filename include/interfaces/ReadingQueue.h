@@ -5,6 +5,8 @@
 #include <vector>
 #include <array>
 
+#include "interfaces/PipelineEdge.h"
+#include "interfaces/WindowPool.h"
 #include "utils/constants.h"
 
 class ReadingQueue {
@@ -13,14 +15,10 @@ public:
     // Static method to access the single instance
     static ReadingQueue& getInstance();
 
-    // The structure used for inter-thread communication
-    typedef struct {
-        std::array<std::array<uint8_t, 3>, VECTOR_SIZE> inputs_ch0;
-        std::array<std::array<uint8_t, 3>, VECTOR_SIZE> inputs_ch1;
-    } mail_t;
-
-    // Mail object for inter-thread communication
-    Mail<mail_t, 1> mail_box;  // Queue with size 4, can be adjusted as necessary
+    // Pooled windows from the acquisition threads to inference. Only the pointer is queued, the
+    // reference passes with it. The consumer sleeps in get() while the edge is empty, a full edge
+    // applies READING_QUEUE_POLICY. Dropped windows return to the pool.
+    PipelineEdge<WindowPool::Buffer, READING_QUEUE_DEPTH> queue;
 
 private:
     // Private constructor to prevent direct instantiation
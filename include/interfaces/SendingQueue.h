@@ -5,6 +5,8 @@
 #include <vector>
 #include <array>
 
+#include "interfaces/PipelineEdge.h"
+#include "interfaces/WindowPool.h"
 #include "utils/constants.h"
 
 class SendingQueue {
@@ -13,16 +15,8 @@ public:
     // Static method to access the single instance
     static SendingQueue& getInstance();
 
-    // The structure used for inter-thread communication
-    typedef struct {
-        std::array<std::array<uint8_t, 3>, VECTOR_SIZE> inputs_ch0;
-        std::array<std::array<uint8_t, 3>, VECTOR_SIZE> inputs_ch1;
-        std::array<float, CLASSES> classification_ch0;
-        std::array<float, CLASSES> classification_ch1;                              
-    } mail_t;
-
-    // Mail object for inter-thread communication
-    Mail<mail_t, 1> mail_box;  
+    // Classified windows from inference to the serial sender, a full edge applies SENDING_QUEUE_POLICY
+    PipelineEdge<WindowPool::Buffer, SENDING_QUEUE_DEPTH> queue;
 
 private:
     // Private constructor to prevent direct instantiation
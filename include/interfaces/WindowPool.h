@@ -0,0 +1,83 @@
+#ifndef WINDOW_POOL_H
+#define WINDOW_POOL_H
+
+#include "mbed.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "utils/constants.h"
+
+/**
+ * @class WindowPool
+ * @brief Statically allocated, reference counted buffers that carry the windows of a converter
+ * through every stage of the pipeline.
+ *
+ * The acquisition thread of a converter linearises its windows into a buffer and passes the
+ * pointer through ReadingQueue. Inference reads the windows in place, attaches the
+ * classifications to the same buffer and passes it on through SendingQueue, and the serial
+ * sender serialises straight from it. A stage that keeps a buffer while handing it on takes
+ * a reference with retain(). The buffer returns to the pool when the last reference is released.
+ * Every buffer is stamped when it is taken, so the sender can report the latency of the pipeline.
+ */
+class WindowPool {
+public:
+
+    // Static method to access the single instance
+    static WindowPool& getInstance();
+
+    // The windows of all channels of one converter and their classifications
+    struct Buffer {
+        std::array<std::array<std::array<uint8_t, 3>, VECTOR_SIZE>, ADC_CHANNELS> inputs; // One window per channel, oldest value first
+        std::array<uint16_t, ADC_CHANNELS> lengths;     // Values in each window
+        std::array<uint16_t, ADC_CHANNELS> new_values;  // Values not in the channel's previous window, 0 if it is not due
+        std::array<std::array<float, CLASSES>, ADC_CHANNELS> classification; // One result per channel, attached by inference
+        uint32_t timestamp_us;                          // get_time_us() when the buffer was taken
+        uint8_t device;                                 // Converter the windows come from
+        std::atomic<uint8_t> references;
+    };
+
+    /**
+     * @brief Takes a buffer with one reference, blocking while all are in use.
+     * @return The buffer, its contents are undefined.
+     */
+    Buffer* alloc(void);
+
+    /**
+     * @brief Adds a reference to a buffer.
+     */
+    void retain(Buffer* buffer);
+
+    /**
+     * @brief Drops a reference, the last one returns the buffer to the pool.
+     */
+    void release(Buffer* buffer);
+
+    /**
+     * @brief Coalesce callback of the pipeline edges: a newer buffer of the same converter
+     * supersedes a queued one. The new values of the queued windows are added to the newer
+     * ones, which hold them as well, so inference still sees every value once.
+     */
+    static bool coalesce(Buffer* latest, Buffer* queued);
+
+    /**
+     * @brief Microseconds since the pool was created, from the low power ticker so it runs in deep sleep.
+     */
+    uint32_t get_time_us(void);
+
+private:
+    MemoryPool<Buffer, WINDOW_POOL_SIZE> m_pool;
+    LowPowerTimer m_clock;
+
+    // Private constructor to prevent direct instantiation
+    WindowPool(void);
+
+    // Private destructor (optional)
+    ~WindowPool();
+
+    // Deleted copy constructor and assignment operator to prevent copies
+    WindowPool(const WindowPool&) = delete;
+    WindowPool& operator=(const WindowPool&) = delete;
+};
+
+#endif // WINDOW_POOL_H
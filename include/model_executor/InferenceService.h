@@ -0,0 +1,82 @@
+#ifndef INFERENCE_SERVICE_H
+#define INFERENCE_SERVICE_H
+
+#include "mbed.h"
+#include <cstdint>
+#include <vector>
+
+#include "utils/FixedPoint.h"
+#include "utils/constants.h"
+
+/**
+ * @class InferenceService
+ * @brief Runs model inference on its own thread, fed by jobs from any producer.
+ *
+ * A job names the normalised window to classify, the model and the slot that
+ * receives the CLASSES results. submit() files it among the pending jobs of its
+ * priority and posts one event to the inference queue; every event runs the most
+ * urgent job pending at that time, so a high priority job overtakes normal ones
+ * that were submitted before it. When the result is written, the job's done
+ * callback runs on the inference thread, e.g. to release a semaphore or post to
+ * the queue of the producer.
+ *
+ * The thread runs below the acquisition threads, so the DRDY path and the
+ * decimation are never held up by a model execution. With COOPERATIVE_SCHEDULING
+ * there is no inference thread: the events go to the EventLoop, where a model
+ * execution runs to completion between the blocks of the converters.
+ */
+class InferenceService: private mbed::NonCopyable<InferenceService> {
+    public:
+        /// Scheduling order of jobs, High first.
+        enum class Priority { High = 0, Normal = 1, Low = 2 };
+
+#ifdef PREPROCESSING_FIXED_POINT
+        typedef std::vector<q15_t> input_t;     ///< Normalised window in Q15.
+#else
+        typedef std::vector<float> input_t;     ///< Normalised window.
+#endif
+
+        /// One classification. Owned by the producer, it must stay valid until done is called.
+        struct Job {
+            const input_t* window;          ///< Model input.
+            uint8_t model;                  ///< Model id, 0 to MODELS - 1.
+            float* result;                  ///< Slot receiving CLASSES values.
+            Callback<void(Job*)> done;      ///< Called on the inference thread or the EventLoop after the result is written.
+        };
+
+        /// Models compiled into the firmware. Only the classifier of model_pte.h is.
+        static const int MODELS = 1;
+
+        /// Pending jobs per priority, one per channel of every converter.
+        static const int QUEUE_DEPTH = ADC_DEVICES * ADC_CHANNELS;
+
+        static InferenceService& getInstance(void);
+
+        /**
+         * @brief Queues a job. May be called from any thread or interrupt.
+         * @return False if the model id is unknown or the jobs of this priority are full.
+         */
+        bool submit(Job* job, Priority priority = Priority::Normal);
+
+    private:
+        static const int PRIORITIES = 3;
+
+#ifndef COOPERATIVE_SCHEDULING
+        EventQueue  m_queue;            ///< One event per submitted job.
+        Thread      m_thread;
+#endif
+
+        // Pending jobs of each priority, oldest first
+        Job*        m_pending[PRIORITIES][QUEUE_DEPTH];
+        int         m_pending_head[PRIORITIES];
+        int         m_pending_count[PRIORITIES];
+
+        InferenceService(void);
+
+        /**
+         * @brief Runs the most urgent pending job.
+         */
+        void run_next(void);
+};
+
+#endif // INFERENCE_SERVICE_H
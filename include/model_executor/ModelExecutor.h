@@ -5,13 +5,20 @@
 #include <memory>
 #include <stdint.h>
 
+#include "mbed.h"
+
+#include "utils/FixedPoint.h"
+
 class ModelExecutor {
 public:
     // Singleton access
     static ModelExecutor& getInstance(size_t pool_size = 512);
 
     // Run the model with the provided inputs
-    std::vector<float> run_model(std::vector<float> feature_vector);
+    std::vector<float> run_model(const std::vector<float>& feature_vector);
+
+    // Run the model with Q15 inputs, converted to float (times factor) while filling the input tensor
+    std::vector<float> run_model(const std::vector<q15_t>& feature_vector, float factor);
 
     // Delete copy constructor and assignment operator to enforce singleton pattern
     ModelExecutor(const ModelExecutor&) = delete;
@@ -24,6 +31,9 @@ private:
     // Private destructor
     ~ModelExecutor();
 
+    // Loads the program, fills the input tensor through write_inputs(data, count) and executes it
+    std::vector<float> execute(Callback<void(float*, int)> write_inputs);
+
     uint8_t* m_method_allocator_pool;
     size_t m_allocator_pool_size;
 };
@@ -0,0 +1,86 @@
+#ifndef ADAPTIVE_NORMALIZER_H
+#define ADAPTIVE_NORMALIZER_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+#include "preprocessing/OnlineMinMax.h"
+#include "utils/FixedPoint.h"
+
+/**
+ * @class AdaptiveNormalizer
+ * @brief Per-channel min-max normalisation with bounds that follow electrode drift.
+ *
+ * The bounds are the minimum and maximum of all downsampled values seen within a
+ * long horizon (e.g. one day). They are updated incrementally with every new value,
+ * so normalising a window only needs a single pass over the raw bytes.
+ *
+ * Min-max normalisation is invariant to the linear conversion to mV, so bounds are
+ * kept as Q31 fractions of the full scale and windows are scaled straight from the
+ * raw codes. The 24-bit codes are exact in float, so both the float and the Q15
+ * output paths see identical bounds.
+ */
+class AdaptiveNormalizer {
+    public:
+        /**
+         * @brief Creates a normaliser for one channel.
+         * @param block_count Number of blocks in the min/max horizon.
+         * @param block_length Number of downsampled values per block.
+         * @param min_span Smallest allowed distance between the bounds in mV. Narrower
+         *        bounds are widened around their centre, so noise on a flat signal is
+         *        not blown up to the full range.
+         * @param databits, vref, gain Conversion parameters of the ADC.
+         */
+        AdaptiveNormalizer(std::size_t block_count, std::size_t block_length, float min_span,
+                           int databits, float vref, float gain);
+
+        /**
+         * @brief Updates the horizon with the newest values of a window and normalises it.
+         * @param window, length Raw ADC bytes, oldest value first, and their number.
+         * @param new_values Number of values at the end of the window that have not been
+         *        seen before. The first window of a channel passes its full size.
+         * @param factor Scale applied after normalising to [0, 1]. Values outside the
+         *        bounds, e.g. older values of the window once detrended, are clamped,
+         *        so every output lies in [0, factor].
+         * @param outputs Receives the normalised window. Its capacity is reused.
+         * @param trend_offset, trend_slope Line in Q31 units (see LinearDetrend) that is
+         *        subtracted from the window during the same pass. Bounds then follow the
+         *        detrended values.
+         */
+        void process(const std::array<uint8_t, 3>* window, std::size_t length, std::size_t new_values,
+                     float factor, std::vector<float>& outputs,
+                     float trend_offset = 0.0f, float trend_slope = 0.0f);
+
+        /**
+         * @brief Fixed-point variant of process().
+         *
+         * Outputs are in Q15, clamped as in process() and saturated to Q15_MAX at
+         * the upper bound. They differ from process() with a factor of 1, rounded
+         * to Q15, by at most 1 LSB.
+         */
+        void process_q15(const std::array<uint8_t, 3>* window, std::size_t length, std::size_t new_values,
+                         std::vector<q15_t>& outputs,
+                         float trend_offset = 0.0f, float trend_slope = 0.0f);
+
+        /**
+         * @brief Returns the current lower bound in mV.
+         */
+        float get_min(void) const;
+
+        /**
+         * @brief Returns the current upper bound in mV.
+         */
+        float get_max(void) const;
+
+    private:
+        OnlineMinMax m_min_max;
+        float m_min_span;       ///< Minimum span in Q31 units.
+        float m_mv_per_unit;    ///< mV per Q31 unit.
+
+        void update_from_window(const std::array<uint8_t, 3>* window, std::size_t length, std::size_t new_values,
+                                float trend_offset, float trend_slope);
+        void get_bounds(float& lower, float& upper) const;
+};
+
+#endif // ADAPTIVE_NORMALIZER_H
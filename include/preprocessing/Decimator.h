@@ -0,0 +1,89 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class Decimator
+ * @brief Multi-stage fixed-point decimator for raw AD7124 codes.
+ *
+ * The first stage is a fifth order CIC filter that decimates by ratio / 2.
+ * The second stage is a 63-tap polyphase FIR filter that compensates the
+ * passband droop of the CIC filter and decimates by the remaining factor 2.
+ * The output is flat up to 0.3 of the output rate. The FIR stopband starts at
+ * the output Nyquist frequency and the CIC suppresses the bands that fold
+ * onto the FIR passband, so everything that would alias into the output is
+ * rejected by at least 65 dB (host/test/test_decimator.cpp).
+ *
+ * The droop compensation assumes a CIC ratio of 8 or more; the small ratios
+ * the benchmarks use raise the passband edge by up to 1.6 dB.
+ * Samples are signed 24-bit codes (offset binary code minus 0x800000) and
+ * the outputs use the same scale.
+ */
+class Decimator {
+    public:
+        /// Largest decimation ratio, the CIC output of 2^23 * (MAX_RATIO / 2)^5 must fit the 64-bit registers.
+        static constexpr unsigned int MAX_RATIO = 512;
+
+        /**
+         * @brief Creates a decimator with the given overall decimation ratio.
+         * @param decimation_ratio Number of input samples per output sample.
+         *        Must be even, 2 to MAX_RATIO. Anything else asserts.
+         */
+        Decimator(unsigned int decimation_ratio);
+
+        /**
+         * @brief Returns the valid ratio closest to an output period.
+         * @param input_rate Input samples per second.
+         * @param output_period Seconds per output sample.
+         * @return The nearest even ratio, limited to 2 to MAX_RATIO. The period it gives,
+         *         ratio / input_rate, differs from output_period unless the product is even.
+         */
+        static unsigned int ratio_for_period(float input_rate, float output_period);
+
+        /**
+         * @brief Filters a block of samples.
+         * @param inputs Pointer to count signed 24-bit samples.
+         * @param count Number of input samples.
+         * @param outputs Buffer receiving the decimated samples. It must hold
+         *        at least count / decimation_ratio + 1 values.
+         * @return Number of samples written to outputs.
+         */
+        std::size_t process(const int32_t* inputs, std::size_t count, int32_t* outputs);
+
+        /**
+         * @brief Clears the filter state.
+         */
+        void reset(void);
+
+        /**
+         * @brief Returns the overall decimation ratio.
+         */
+        unsigned int get_ratio(void) const;
+
+    private:
+        static constexpr int CIC_ORDER = 5;
+        static constexpr std::size_t FIR_PHASE_LENGTH = 32;
+
+        unsigned int m_ratio;
+        unsigned int m_cic_ratio;
+        int64_t m_cic_gain;
+
+        // Integrator and comb registers use modular arithmetic on purpose.
+        std::array<uint64_t, CIC_ORDER> m_integrators;
+        std::array<uint64_t, CIC_ORDER> m_combs;
+        unsigned int m_cic_phase;
+
+        // Delay lines of the even and odd FIR polyphase branches.
+        std::array<int32_t, FIR_PHASE_LENGTH> m_even_delay;
+        std::array<int32_t, FIR_PHASE_LENGTH> m_odd_delay;
+        std::size_t m_delay_index;
+        bool m_odd_sample;
+
+        bool cic_push(int32_t sample, int32_t& output);
+        bool fir_push(int32_t sample, int32_t& output);
+};
+
+#endif // DECIMATOR_H
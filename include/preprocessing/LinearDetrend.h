@@ -0,0 +1,62 @@
+#ifndef LINEAR_DETREND_H
+#define LINEAR_DETREND_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+#include "utils/FixedPoint.h"
+
+/**
+ * @class LinearDetrend
+ * @brief Least-squares line over a sliding window, updated in O(1) per value.
+ *
+ * The running sums Σx and Σxt (t = 0 for the oldest value) are kept as exact
+ * 64-bit integers. Σt and Σt² only depend on the number of values and are
+ * evaluated in closed form. The fitted line can be subtracted while the window
+ * is normalised, so detrending needs no pass of its own.
+ */
+class LinearDetrend {
+    public:
+        /**
+         * @brief Creates a detrending stage for windows of window_size values.
+         */
+        LinearDetrend(std::size_t window_size);
+
+        /**
+         * @brief Slides the window by one value.
+         * @param value The new value as Q31 fraction of the full scale.
+         */
+        void update(q31_t value);
+
+        /**
+         * @brief Slides the window by the newest values of a received window.
+         * @param window, length Raw ADC bytes, oldest value first, and their number.
+         * @param new_values Number of values at the end of the window that have not been seen before.
+         */
+        void update(const std::array<uint8_t, 3>* window, std::size_t length, std::size_t new_values);
+
+        /**
+         * @brief Returns the value of the fitted line at the oldest position (t = 0) in Q31 units.
+         */
+        float get_offset(void) const;
+
+        /**
+         * @brief Returns the slope of the fitted line in Q31 units per value.
+         */
+        float get_slope(void) const;
+
+    private:
+        std::vector<q31_t> m_window;    ///< Circular copy of the window, needed to drop the oldest value.
+        std::size_t m_size;
+        std::size_t m_count;
+        std::size_t m_oldest;
+        int64_t m_sum_x;                ///< Σx
+        int64_t m_sum_xt;               ///< Σxt
+        float m_offset;
+        float m_slope;
+
+        void fit(void);
+};
+
+#endif // LINEAR_DETREND_H
@@ -0,0 +1,64 @@
+#ifndef MEDIAN_FILTER_H
+#define MEDIAN_FILTER_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class MedianFilter
+ * @brief Streaming sliding median with optional Hampel-style spike rejection.
+ *
+ * The samples of the window are split into a lower and an upper half, each a
+ * binary heap of window slots: the lower half keeps its largest sample on top,
+ * the upper half its smallest, so the median is read from the tops. A new sample
+ * overwrites the oldest one in its slot, which stays in its half and is sifted
+ * into place, and only if it crossed the median are the two tops exchanged, so
+ * each update costs O(log w). All storage is allocated once in the constructor.
+ */
+class MedianFilter {
+    public:
+        /**
+         * @brief Creates a filter over the last window_size samples.
+         * @param window_size Window length. Values below 2 disable the filter.
+         * @param spike_threshold If greater than 0, a sample is only replaced by the
+         *        median when it deviates from it by more than this amount (Hampel
+         *        filter). If 0, the median is always returned.
+         */
+        MedianFilter(std::size_t window_size, int32_t spike_threshold);
+
+        /**
+         * @brief Adds a sample to the window.
+         * @param sample The new sample.
+         * @return The filtered sample.
+         */
+        int32_t update(int32_t sample);
+
+        /**
+         * @brief Returns the median of the current window.
+         */
+        int32_t get_median(void) const;
+
+    private:
+        static const int LOWER = 0;
+        static const int UPPER = 1;
+
+        std::vector<int32_t> m_samples;     ///< Circular window of samples.
+        std::vector<int> m_halves[2];       ///< Heaps of the slots of the lower and the upper half.
+        int m_counts[2];                    ///< Slots in each half, the lower half holds the odd one.
+        std::vector<uint8_t> m_half;        ///< Half of each slot.
+        std::vector<int> m_position;        ///< Position of each slot in the heap of its half.
+        int m_size;
+        int m_count;
+        int m_index;                        ///< Slot of the oldest sample, overwritten next.
+        int32_t m_spike_threshold;
+
+        /// Returns true if sample a belongs nearer the top of the half than sample b.
+        bool above(int half, int32_t a, int32_t b) const;
+        int32_t top(int half) const;
+        void place(int half, int position, int slot);
+        void sift_up(int half, int position);
+        void sift_down(int half, int position);
+};
+
+#endif // MEDIAN_FILTER_H
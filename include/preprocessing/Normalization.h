@@ -5,11 +5,17 @@
 #include <array>
 #include <cstdint>
 
+#include "utils/FixedPoint.h"
+
 class Preprocessing {
 public:
     static std::vector<float> minMaxNormalization(std::vector<float> inputs, float minValue, float maxValue, float factor);
     static std::vector<float> zScoreNormalization(std::vector<float> inputs, float factor);
     static std::array<uint8_t, 3> computeMean(std::vector<std::array<uint8_t,3>> values);
+
+    // Fixed-point variants. Results differ from the float path rounded to Q15 by at most 1 LSB.
+    static q15_t minMaxNormalizeQ15(int64_t value, int64_t minValue, int64_t reciprocal);
+    static int64_t minMaxReciprocal(int64_t minValue, int64_t maxValue);
 };
 
 #endif // PREPROCESSING_H
\ No newline at end of file
@@ -6,23 +6,35 @@
 
 class OnlineMinMax {
     private:
-        std::vector<float> window;
-        std::size_t windowSize;
-        std::size_t currentIndex;
-        std::size_t count;  // Number of valid elements (max equals windowSize)
+        // Extrema of the completed blocks, stored as a circular buffer.
+        std::vector<float> blockMin;
+        std::vector<float> blockMax;
+        std::size_t blockCount;
+        std::size_t blockLength;
+        std::size_t currentBlock;
+        std::size_t completedBlocks;  // Number of valid completed blocks (max equals blockCount)
+
+        // Extrema of the block that is currently being filled.
+        float currentMin;
+        float currentMax;
+        std::size_t currentCount;
 
     public:
-        // Constructor that sets the fixed window size.
-        OnlineMinMax(std::size_t windowSize);
+        // Constructor that sets the horizon to blockCount blocks of blockLength values.
+        // Memory grows with blockCount only, so horizons of days stay cheap.
+        OnlineMinMax(std::size_t blockCount, std::size_t blockLength);
 
-        // Update the window with new values.
-        void update(std::vector<float> arr);
+        // Update the horizon with a new value in O(1).
+        void update(float value);
 
-        // Return the maximum value in the current window.
+        // Return the maximum value in the current horizon.
         float getMaxValue(void) const;
 
-        // Return the minimum value in the current window.
+        // Return the minimum value in the current horizon.
         float getMinValue(void) const;
+
+        // Return true once at least one value has been seen.
+        bool hasValues(void) const;
 };
 
-#endif // ONLINE_MIN_MAX
\ No newline at end of file
+#endif // ONLINE_MIN_MAX
@@ -10,6 +10,7 @@
 #include "serial_mail_sender/serial_mail_generated.h" 
 #include "flatbuffers/flatbuffers.h"
 #include "interfaces/SendingQueue.h"
+#include "interfaces/WindowPool.h"
 
 class SerialMailSender {
 public:
@@ -20,9 +21,14 @@ public:
     SerialMailSender(const SerialMailSender&) = delete;
     SerialMailSender& operator=(const SerialMailSender&) = delete;
 
-    // Method to serialize and send SerialMail data
+    // Method to serialize and send SerialMail data, forever on the sending thread
     void sendMail(void);
 
+    // Sends the next queued window without waiting, returns false if there was none.
+    // Handler of the EventLoop with COOPERATIVE_SCHEDULING, where the write blocks the loop
+    // while the transmit buffer drains
+    bool send_next(void);
+
 private:
     // Private constructor
     SerialMailSender(void);
@@ -33,17 +39,11 @@ private:
     // Static BufferedSerial instance
     static BufferedSerial m_serial_port;
 
-    // Function to convert inputs to SerialMail::Value array
-    std::vector<SerialMail::Value> convertToSerialMailValues(const std::vector<std::array<uint8_t, 3>>& inputs);
-
-    void convertMailToVectors(const SendingQueue::mail_t &sending_mail,
-        std::vector<std::array<uint8_t, 3>> &vec_ch0,
-        std::vector<std::array<uint8_t, 3>> &vec_ch1);
-
-    void convertMailToFloatVectors(const SendingQueue::mail_t &sending_mail,
-        std::vector<float> &vec_ch0,
-        std::vector<float> &vec_ch1);
+    // Builder reused for every mail, it keeps its buffer once grown
+    flatbuffers::FlatBufferBuilder m_builder;
 
+    // Serializes and writes one window and releases it
+    void send(WindowPool::Buffer* window);
 };
 
 #endif // SERIAL_MAIL_SENDER_H
@@ -17,6 +17,9 @@ namespace SerialMail {
 
 struct Value;
 
+struct Channel;
+struct ChannelBuilder;
+
 struct SerialMail;
 struct SerialMailBuilder;
 
@@ -49,36 +52,89 @@ FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(1) Value FLATBUFFERS_FINAL_CLASS {
 };
 FLATBUFFERS_STRUCT_END(Value, 3);
 
-struct SerialMail FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
-  typedef SerialMailBuilder Builder;
+struct Channel FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef ChannelBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
-    VT_INPUTS_CH0 = 4,
-    VT_INPUTS_CH1 = 6,
-    VT_CLASSIFICATION_CH0 = 8,
-    VT_CLASSIFICATION_CH1 = 10
+    VT_INPUTS = 4,
+    VT_CLASSIFICATION = 6
   };
-  const ::flatbuffers::Vector<const Value *> *inputs_ch0() const {
-    return GetPointer<const ::flatbuffers::Vector<const Value *> *>(VT_INPUTS_CH0);
+  const ::flatbuffers::Vector<const Value *> *inputs() const {
+    return GetPointer<const ::flatbuffers::Vector<const Value *> *>(VT_INPUTS);
+  }
+  const ::flatbuffers::Vector<float> *classification() const {
+    return GetPointer<const ::flatbuffers::Vector<float> *>(VT_CLASSIFICATION);
+  }
+  bool Verify(::flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_INPUTS) &&
+           verifier.VerifyVector(inputs()) &&
+           VerifyOffset(verifier, VT_CLASSIFICATION) &&
+           verifier.VerifyVector(classification()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ChannelBuilder {
+  typedef Channel Table;
+  ::flatbuffers::FlatBufferBuilder &fbb_;
+  ::flatbuffers::uoffset_t start_;
+  void add_inputs(::flatbuffers::Offset<::flatbuffers::Vector<const Value *>> inputs) {
+    fbb_.AddOffset(Channel::VT_INPUTS, inputs);
   }
-  const ::flatbuffers::Vector<const Value *> *inputs_ch1() const {
-    return GetPointer<const ::flatbuffers::Vector<const Value *> *>(VT_INPUTS_CH1);
+  void add_classification(::flatbuffers::Offset<::flatbuffers::Vector<float>> classification) {
+    fbb_.AddOffset(Channel::VT_CLASSIFICATION, classification);
   }
-  const ::flatbuffers::Vector<float> *classification_ch0() const {
-    return GetPointer<const ::flatbuffers::Vector<float> *>(VT_CLASSIFICATION_CH0);
+  explicit ChannelBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
   }
-  const ::flatbuffers::Vector<float> *classification_ch1() const {
-    return GetPointer<const ::flatbuffers::Vector<float> *>(VT_CLASSIFICATION_CH1);
+  ::flatbuffers::Offset<Channel> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = ::flatbuffers::Offset<Channel>(end);
+    return o;
+  }
+};
+
+inline ::flatbuffers::Offset<Channel> CreateChannel(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    ::flatbuffers::Offset<::flatbuffers::Vector<const Value *>> inputs = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<float>> classification = 0) {
+  ChannelBuilder builder_(_fbb);
+  builder_.add_classification(classification);
+  builder_.add_inputs(inputs);
+  return builder_.Finish();
+}
+
+inline ::flatbuffers::Offset<Channel> CreateChannelDirect(
+    ::flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<Value> *inputs = nullptr,
+    const std::vector<float> *classification = nullptr) {
+  auto inputs__ = inputs ? _fbb.CreateVectorOfStructs<Value>(*inputs) : 0;
+  auto classification__ = classification ? _fbb.CreateVector<float>(*classification) : 0;
+  return CreateChannel(
+      _fbb,
+      inputs__,
+      classification__);
+}
+
+struct SerialMail FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
+  typedef SerialMailBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_CHANNELS = 4,
+    VT_DEVICE = 6
+  };
+  const ::flatbuffers::Vector<::flatbuffers::Offset<Channel>> *channels() const {
+    return GetPointer<const ::flatbuffers::Vector<::flatbuffers::Offset<Channel>> *>(VT_CHANNELS);
+  }
+  uint8_t device() const {
+    return GetField<uint8_t>(VT_DEVICE, 0);
   }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
-           VerifyOffset(verifier, VT_INPUTS_CH0) &&
-           verifier.VerifyVector(inputs_ch0()) &&
-           VerifyOffset(verifier, VT_INPUTS_CH1) &&
-           verifier.VerifyVector(inputs_ch1()) &&
-           VerifyOffset(verifier, VT_CLASSIFICATION_CH0) &&
-           verifier.VerifyVector(classification_ch0()) &&
-           VerifyOffset(verifier, VT_CLASSIFICATION_CH1) &&
-           verifier.VerifyVector(classification_ch1()) &&
+           VerifyOffset(verifier, VT_CHANNELS) &&
+           verifier.VerifyVector(channels()) &&
+           verifier.VerifyVectorOfTables(channels()) &&
+           VerifyField<uint8_t>(verifier, VT_DEVICE, 1) &&
            verifier.EndTable();
   }
 };
@@ -87,17 +143,11 @@ struct SerialMailBuilder {
   typedef SerialMail Table;
   ::flatbuffers::FlatBufferBuilder &fbb_;
   ::flatbuffers::uoffset_t start_;
-  void add_inputs_ch0(::flatbuffers::Offset<::flatbuffers::Vector<const Value *>> inputs_ch0) {
-    fbb_.AddOffset(SerialMail::VT_INPUTS_CH0, inputs_ch0);
-  }
-  void add_inputs_ch1(::flatbuffers::Offset<::flatbuffers::Vector<const Value *>> inputs_ch1) {
-    fbb_.AddOffset(SerialMail::VT_INPUTS_CH1, inputs_ch1);
-  }
-  void add_classification_ch0(::flatbuffers::Offset<::flatbuffers::Vector<float>> classification_ch0) {
-    fbb_.AddOffset(SerialMail::VT_CLASSIFICATION_CH0, classification_ch0);
+  void add_channels(::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<Channel>>> channels) {
+    fbb_.AddOffset(SerialMail::VT_CHANNELS, channels);
   }
-  void add_classification_ch1(::flatbuffers::Offset<::flatbuffers::Vector<float>> classification_ch1) {
-    fbb_.AddOffset(SerialMail::VT_CLASSIFICATION_CH1, classification_ch1);
+  void add_device(uint8_t device) {
+    fbb_.AddElement<uint8_t>(SerialMail::VT_DEVICE, device, 0);
   }
   explicit SerialMailBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
@@ -112,34 +162,23 @@ struct SerialMailBuilder {
 
 inline ::flatbuffers::Offset<SerialMail> CreateSerialMail(
     ::flatbuffers::FlatBufferBuilder &_fbb,
-    ::flatbuffers::Offset<::flatbuffers::Vector<const Value *>> inputs_ch0 = 0,
-    ::flatbuffers::Offset<::flatbuffers::Vector<const Value *>> inputs_ch1 = 0,
-    ::flatbuffers::Offset<::flatbuffers::Vector<float>> classification_ch0 = 0,
-    ::flatbuffers::Offset<::flatbuffers::Vector<float>> classification_ch1 = 0) {
+    ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<Channel>>> channels = 0,
+    uint8_t device = 0) {
   SerialMailBuilder builder_(_fbb);
-  builder_.add_classification_ch1(classification_ch1);
-  builder_.add_classification_ch0(classification_ch0);
-  builder_.add_inputs_ch1(inputs_ch1);
-  builder_.add_inputs_ch0(inputs_ch0);
+  builder_.add_channels(channels);
+  builder_.add_device(device);
   return builder_.Finish();
 }
 
 inline ::flatbuffers::Offset<SerialMail> CreateSerialMailDirect(
     ::flatbuffers::FlatBufferBuilder &_fbb,
-    const std::vector<Value> *inputs_ch0 = nullptr,
-    const std::vector<Value> *inputs_ch1 = nullptr,
-    const std::vector<float> *classification_ch0 = nullptr,
-    const std::vector<float> *classification_ch1 = nullptr) {
-  auto inputs_ch0__ = inputs_ch0 ? _fbb.CreateVectorOfStructs<Value>(*inputs_ch0) : 0;
-  auto inputs_ch1__ = inputs_ch1 ? _fbb.CreateVectorOfStructs<Value>(*inputs_ch1) : 0;
-  auto classification_ch0__ = classification_ch0 ? _fbb.CreateVector<float>(*classification_ch0) : 0;
-  auto classification_ch1__ = classification_ch1 ? _fbb.CreateVector<float>(*classification_ch1) : 0;
+    const std::vector<::flatbuffers::Offset<Channel>> *channels = nullptr,
+    uint8_t device = 0) {
+  auto channels__ = channels ? _fbb.CreateVector<::flatbuffers::Offset<Channel>>(*channels) : 0;
   return CreateSerialMail(
       _fbb,
-      inputs_ch0__,
-      inputs_ch1__,
-      classification_ch0__,
-      classification_ch1__);
+      channels__,
+      device);
 }
 
 inline const SerialMail *GetSerialMail(const void *buf) {
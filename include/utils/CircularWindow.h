@@ -0,0 +1,100 @@
+#ifndef CIRCULAR_WINDOW_H
+#define CIRCULAR_WINDOW_H
+
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @class CircularWindow
+ * @brief Sliding window of the last length values in statically allocated storage.
+ *
+ * A new value overwrites the oldest one, so pushing costs O(1) regardless of
+ * the window length. copy_to() writes the window oldest first with at most
+ * two contiguous copies, which lets the caller build a linear snapshot
+ * directly in its destination buffer (e.g. a mail).
+ *
+ * @tparam T Value type.
+ * @tparam Capacity Maximum window length.
+ */
+template <typename T, std::size_t Capacity>
+class CircularWindow {
+    public:
+        /**
+         * @brief Creates an empty window.
+         * @param length Window length, limited to Capacity.
+         */
+        explicit CircularWindow(std::size_t length = Capacity)
+            : m_length(std::min(std::max<std::size_t>(length, 1), Capacity)), m_next(0), m_count(0) {}
+
+        /**
+         * @brief Appends a value, replacing the oldest one once the window is full.
+         * @return True if a value was replaced.
+         */
+        bool push(const T& value) {
+            m_values[m_next] = value;
+            m_next = (m_next + 1 == m_length) ? 0 : m_next + 1;
+            if (m_count < m_length) {
+                m_count++;
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Copies the window, oldest value first, to destination.
+         * @param destination Buffer of at least size() values.
+         */
+        void copy_to(T* destination) const {
+            // Before the window is full, the oldest value is at index 0
+            const std::size_t oldest = (m_count < m_length) ? 0 : m_next;
+            const std::size_t first_part = m_count - oldest;
+            std::copy(m_values + oldest, m_values + oldest + first_part, destination);
+            std::copy(m_values, m_values + oldest, destination + first_part);
+        }
+
+        /**
+         * @brief Returns the value at index, 0 being the oldest.
+         */
+        const T& operator[](std::size_t index) const {
+            const std::size_t oldest = (m_count < m_length) ? 0 : m_next;
+            const std::size_t position = oldest + index;
+            return m_values[(position >= m_length) ? position - m_length : position];
+        }
+
+        /**
+         * @brief Changes the window length and removes all values.
+         * @param length Window length, limited to Capacity.
+         */
+        void set_length(std::size_t length) {
+            m_length = std::min(std::max<std::size_t>(length, 1), Capacity);
+            clear();
+        }
+
+        /**
+         * @brief Removes all values.
+         */
+        void clear(void) {
+            m_next = 0;
+            m_count = 0;
+        }
+
+        std::size_t size(void) const {
+            return m_count;
+        }
+
+        std::size_t length(void) const {
+            return m_length;
+        }
+
+        bool full(void) const {
+            return m_count == m_length;
+        }
+
+    private:
+        T m_values[Capacity];
+        std::size_t m_length;   ///< Window length, at most Capacity.
+        std::size_t m_next;     ///< Slot written by the next push.
+        std::size_t m_count;    ///< Number of values, at most m_length.
+};
+
+#endif // CIRCULAR_WINDOW_H
@@ -1,12 +1,13 @@
 #ifndef CONVERSION_H
 #define CONVERSION_H
 
-#include <cstdio>    // Include this header for printf
-#include <vector>    // Include this header for std::vector
 #include <array>     // Include this header for std::array
 #include <cstdint>   // Include this header for uint8_t (optional, but useful)
 
-// Function declaration (prototype)
-std::vector<float> get_analog_inputs(std::vector<std::array<uint8_t,3>> byte_inputs, int databits, float vref, float gain);
+// Converts the three offset binary bytes of a bipolar AD7124 conversion into a signed 24-bit code
+int32_t bytes_to_signed_code(const std::array<uint8_t,3>& bytes);
+
+// Converts a signed 24-bit code back into three offset binary bytes
+std::array<uint8_t,3> signed_code_to_bytes(int32_t code);
 
 #endif // CONVERSION_H
@@ -0,0 +1,45 @@
+#ifndef FILE_BLOCK_DEVICE_H
+#define FILE_BLOCK_DEVICE_H
+
+#include "mbed.h"
+#include "blockdevice/BlockDevice.h"
+#include <cstdio>
+
+/**
+ * @class FileBlockDevice
+ * @brief BlockDevice backed by a file, for host builds.
+ *
+ * Behaves like erased flash: the file is created filled with 0xFF and
+ * erasing writes 0xFF. Reads, programs and erases work on single bytes.
+ */
+class FileBlockDevice: public BlockDevice, private mbed::NonCopyable<FileBlockDevice> {
+    public:
+        /**
+         * @param path File holding the device contents, created if missing.
+         * @param size Size of the device in bytes.
+         */
+        FileBlockDevice(const char* path, bd_size_t size);
+        ~FileBlockDevice(void);
+
+        int init(void) override;
+        int deinit(void) override;
+        int read(void* buffer, bd_addr_t address, bd_size_t size) override;
+        int program(const void* buffer, bd_addr_t address, bd_size_t size) override;
+        int erase(bd_addr_t address, bd_size_t size) override;
+        bd_size_t get_read_size(void) const override;
+        bd_size_t get_program_size(void) const override;
+        bd_size_t get_erase_size(void) const override;
+        using BlockDevice::get_erase_size;
+        bd_size_t size(void) const override;
+        const char* get_type(void) const override;
+
+    private:
+        const char* m_path;
+        bd_size_t   m_size;
+        FILE*       m_file;
+        int         m_init_count;
+
+        bool in_range(bd_addr_t address, bd_size_t size) const;
+};
+
+#endif // FILE_BLOCK_DEVICE_H
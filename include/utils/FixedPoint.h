@@ -0,0 +1,47 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <array>
+#include <cstdint>
+
+// Q31: signed fraction in [-1, 1) with 31 fractional bits
+typedef int32_t q31_t;
+
+// Q15: signed fraction in [-1, 1) with 15 fractional bits
+typedef int16_t q15_t;
+
+#define Q15_ONE 32768
+#define Q15_MAX 32767
+
+/**
+ * @brief Converts the offset binary bytes of a bipolar AD7124 conversion to Q31.
+ *
+ * The result is the input voltage as a fraction of the full scale (VREF / GAIN).
+ * The 24-bit code is shifted into the upper bits, so the conversion is exact.
+ */
+inline q31_t bytes_to_q31(const std::array<uint8_t, 3>& bytes) {
+    uint32_t measurement = ((uint32_t)bytes[0] << 16) | ((uint32_t)bytes[1] << 8) | (uint32_t)bytes[2];
+    return static_cast<q31_t>((measurement ^ 0x800000u) << 8);
+}
+
+/**
+ * @brief Saturates a value to the Q15 range.
+ */
+inline q15_t saturate_q15(int64_t value) {
+    if (value > Q15_MAX) {
+        return Q15_MAX;
+    }
+    if (value < -Q15_ONE) {
+        return -Q15_ONE;
+    }
+    return static_cast<q15_t>(value);
+}
+
+/**
+ * @brief Converts a Q15 value to float.
+ */
+inline float q15_to_float(q15_t value) {
+    return static_cast<float>(value) * (1.0f / Q15_ONE);
+}
+
+#endif // FIXED_POINT_H
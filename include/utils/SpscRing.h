@@ -0,0 +1,118 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class SpscRing
+ * @brief Lock-free, fixed capacity ring buffer for one producer and one consumer.
+ *
+ * The producer (e.g. an interrupt handler) only writes m_head and the consumer
+ * (e.g. a thread) only writes m_tail, so no lock or critical section is needed.
+ * Both indices run freely and are masked on access, which keeps all Capacity
+ * slots usable. A record pushed into a full ring is dropped and counted.
+ *
+ * The class has no platform dependencies, so it can be stress-tested on a host
+ * with one std::thread per side.
+ *
+ * @tparam T Trivially copyable record type.
+ * @tparam Capacity Number of slots, a power of two.
+ */
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        SpscRing(void) : m_head(0), m_tail(0), m_overflow_count(0), m_high_watermark(0) {}
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        /**
+         * @brief Appends a record. Producer side only.
+         * @return False if the ring was full and the record was dropped.
+         */
+        bool push(const T& record) {
+            const std::size_t head = m_head.load(std::memory_order_relaxed);
+            const std::size_t used = head - m_tail.load(std::memory_order_acquire);
+            if (used >= Capacity) {
+                m_overflow_count.store(m_overflow_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+            m_buffer[head & (Capacity - 1)] = record;
+            m_head.store(head + 1, std::memory_order_release);
+
+            if (used + 1 > m_high_watermark.load(std::memory_order_relaxed)) {
+                m_high_watermark.store(used + 1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        /**
+         * @brief Removes the oldest record. Consumer side only.
+         * @return False if the ring was empty.
+         */
+        bool pop(T& record) {
+            return pop(&record, 1) == 1;
+        }
+
+        /**
+         * @brief Removes up to max_count of the oldest records. Consumer side only.
+         * @param records Buffer receiving the records in push order.
+         * @param max_count Capacity of records.
+         * @return Number of records removed.
+         */
+        std::size_t pop(T* records, std::size_t max_count) {
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            std::size_t count = m_head.load(std::memory_order_acquire) - tail;
+            if (count > max_count) {
+                count = max_count;
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                records[i] = m_buffer[(tail + i) & (Capacity - 1)];
+            }
+            m_tail.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief Returns the number of stored records. Exact on the consumer side,
+         * a lower bound of the free space on the producer side.
+         */
+        std::size_t size(void) const {
+            return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+        }
+
+        bool empty(void) const {
+            return size() == 0;
+        }
+
+        static constexpr std::size_t capacity(void) {
+            return Capacity;
+        }
+
+        /**
+         * @brief Returns the number of records dropped because the ring was full.
+         */
+        uint32_t get_overflow_count(void) const {
+            return m_overflow_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the highest fill level seen by the producer.
+         */
+        std::size_t get_high_watermark(void) const {
+            return m_high_watermark.load(std::memory_order_relaxed);
+        }
+
+    private:
+        T m_buffer[Capacity];
+        std::atomic<std::size_t> m_head;            ///< Next slot to write, producer owned.
+        std::atomic<std::size_t> m_tail;            ///< Next slot to read, consumer owned.
+        std::atomic<uint32_t> m_overflow_count;     ///< Producer owned.
+        std::atomic<std::size_t> m_high_watermark;  ///< Producer owned.
+};
+
+#endif // SPSC_RING_H
@@ -4,5 +4,34 @@
 
 #define VECTOR_SIZE 100 // So, we get 100 values from adc each 10 min
 #define CLASSES 2 // So, we get 100 values from adc each 10 min
+#define ADC_CHANNELS 2 // Differential pairs scanned by the AD7124-8 sequencer (AIN0/AIN1, AIN2/AIN3, ...), 1 to 8
+#ifndef ADC_DEVICES // the host benchmarks build one binary per number of converters
+#define ADC_DEVICES 1 // AD7124-8 converters sharing the SPI bus, each with its own CS, 1 to 4
+#endif
+
+// Windows buffered between the threads and what a full queue does with the next one (BackpressurePolicy).
+// Block stalls the producer, DropOldest and DropNewest lose windows, CoalesceLatest keeps the newest
+// window of each converter. Dropped windows skip their new values in detrending and normalisation,
+// coalesced ones pass them on, so only Block and CoalesceLatest suit the reading queue.
+#define READING_QUEUE_DEPTH ADC_DEVICES // windows from acquisition to inference, one per converter
+#define READING_QUEUE_POLICY BackpressurePolicy::Block // every window is classified
+#define SENDING_QUEUE_DEPTH 1 // classified windows from inference to the serial sender
+#define SENDING_QUEUE_POLICY BackpressurePolicy::CoalesceLatest // a slow serial link never stalls inference and acquisition
+#define WINDOW_POOL_SIZE (ADC_DEVICES + READING_QUEUE_DEPTH + SENDING_QUEUE_DEPTH + 2) // buffers of all stages: one being filled per converter, both queues full, one in inference and one being sent
+
+// Keep preprocessing in Q31/Q15 fixed point until the model input
+//#define PREPROCESSING_FIXED_POINT
+
+// Subtract the least-squares line of each window before normalising
+//#define PREPROCESSING_DETRENDING
+
+// Let the node enter deep sleep between conversions: every thread blocks on an
+// event, serial input is disabled and timestamps come from the low power ticker
+//#define LOW_POWER_MODE
+
+// Run acquisition, inference and sending as run-to-completion events on the EventLoop,
+// dispatched by the main thread, instead of on their own threads. Their stacks are not
+// reserved, a long handler delays the others
+//#define COOPERATIVE_SCHEDULING
 
 #endif // CONSTANTS_H
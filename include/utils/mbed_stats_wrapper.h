@@ -4,6 +4,7 @@
 namespace mbed_lib {
     void print_memory_usage();
     void print_cpu_stats();
+    void print_sleep_stats();
     void print_memory_info(const char *label);
 }
 
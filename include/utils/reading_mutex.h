@@ -1,9 +0,0 @@
-#ifndef READING_MUTEX_H
-#define READING_MUTEX_H
-
-#include "mbed.h"
-
-extern Mutex reading_mutex;
-
-
-#endif // READING_MUTEX_H
\ No newline at end of file
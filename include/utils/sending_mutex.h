@@ -1,9 +0,0 @@
-#ifndef SENDING_MUTEX_H
-#define SENDING_MUTEX_H
-
-#include "mbed.h"
-
-extern Mutex sending_mutex;
-
-
-#endif // SENDING_MUTEX_H
\ No newline at end of file
@@ -1,197 +1,642 @@
 
 #include "adc/AD7124.h"
+#include <cmath>
 #include "adc/AD7124-defs.h"
-#include "preprocessing/OnlineMean.h"
+#include "adc/MbedAD7124Bus.h"
+#include "utils/Conversion.h"
 #include "utils/utils.h"
 #include "utils/logger.h"
+#include "interfaces/EventLoop.h"
 #include "interfaces/ReadingQueue.h"
-#include "utils/reading_mutex.h"
-#include <chrono>
-
-void AD7124::ctrl_reg(char RW){
-    /* read/write the control register */
-
-    if(RW == m_read){
-        m_spi.write(AD7124_R | AD7124_ADC_CTRL_REG);
-        TRACE("ADC contr_reg =");
-        for (int i = 0; i<=1; i++){
-            int byte = m_spi.write(0x00);
-            TRACE("%s", byte_to_binary(byte).c_str());
-        }
-        TRACE("\n");
-    } else {
-        m_spi.write(AD7124_ADC_CTRL_REG);
-        const uint16_t contr_reg_settings = AD7124_ADC_CTRL_REG_DATA_STATUS | AD7124_ADC_CTRL_REG_REF_EN | AD7124_ADC_CTRL_REG_CONT_READ | 
-                                        AD7124_ADC_CTRL_REG_POWER_MODE(0) | AD7124_ADC_CTRL_REG_MODE(0)|AD7124_ADC_CTRL_REG_CLK_SEL(0);
-        char contr_reg_set[]={contr_reg_settings>>8 & 0xFF, contr_reg_settings & 0xFF};
 
-        for (int i = 0; i<=1; i++){
-            m_spi.write(contr_reg_set[i]);
-        }   
+// Capacity of the DRDY event queue. One read is pending at a time, the rest is headroom.
+#define DRDY_QUEUE_EVENTS 8
+
+// Stack of the high priority DRDY thread for the conversion reads and the SPI and flash drivers
+#define DRDY_THREAD_BASE_STACK_SIZE 1024
+
+// Once acquisition runs, configure() and calibrate() run on the DRDY thread as well, with a batch
+// of registers and a calibration record on the stack. Rounded up to the 8-byte stack alignment.
+#define DRDY_THREAD_FRAME_SIZE (REGISTER_BATCH_SIZE * sizeof(RegisterValue) + sizeof(CalibrationStore::Record))
+#define DRDY_THREAD_STACK_SIZE ((DRDY_THREAD_BASE_STACK_SIZE + DRDY_THREAD_FRAME_SIZE + 7) & ~std::size_t(7))
+
+/* channel_register_value
+ * Channel n scans the pair AIN(2n)/AIN(2n+1) with setup n, for n below ADC_CHANNELS
+ */
+uint16_t AD7124::channel_register_value(int channel) const{
+    //e.g. channel 1: 10 00 00 (00 - 01 0)(0 00 11) -> setup 1, pins (2) and (3)
+    return AD7124_CH_MAP_REG_CH_ENABLE | AD7124_CH_MAP_REG_SETUP(channel) |
+           AD7124_CH_MAP_REG_AINP(2 * channel) | AD7124_CH_MAP_REG_AINM(2 * channel + 1);
+}
+
+uint32_t AD7124::filter_register_value(const SetupConfig& setup) const{
+    uint32_t value = AD7124_FILT_REG_FILTER(static_cast<uint32_t>(setup.filter)) |
+                     AD7124_FILT_REG_POST_FILTER(static_cast<uint32_t>(setup.post_filter)) |
+                     AD7124_FILT_REG_FS(setup.filter_select);
+    if (setup.reject_60_hz){
+        value |= AD7124_FILT_REG_REJ60;
+    }
+    if (setup.single_cycle){
+        value |= AD7124_FILT_REG_SINGLE_CYCLE;
+    }
+    return value;
+}
+
+uint16_t AD7124::config_register_value(const SetupConfig& setup) const{
+    // Bipolar, buffered inputs, internal 2.5 V reference
+    return AD7124_CFG_REG_BIPOLAR | AD7124_CFG_REG_AIN_BUFP | AD7124_CFG_REG_AINN_BUFM |
+           AD7124_CFG_REG_REF_SEL(2) | AD7124_CFG_REG_PGA(static_cast<uint16_t>(setup.gain));
+}
+
+uint16_t AD7124::control_register_value(PowerMode power_mode) const{
+    // Status byte appended to the data, continuous conversion and continuous read
+    return AD7124_ADC_CTRL_REG_DATA_STATUS | AD7124_ADC_CTRL_REG_REF_EN | AD7124_ADC_CTRL_REG_CONT_READ |
+           AD7124_ADC_CTRL_REG_POWER_MODE(static_cast<uint16_t>(power_mode)) |
+           AD7124_ADC_CTRL_REG_MODE(0) | AD7124_ADC_CTRL_REG_CLK_SEL(0);
+}
+
+void AD7124::reset_shadow(void){
+    for (int address = 0; address < REGISTER_COUNT; address++){
+        m_shadow[address] = 0;
+    }
+    m_shadow[AD7124_ERREN_REG] = 0x000040;
+    m_shadow[AD7124_CH0_MAP_REG] = 0x8001;
+    for (int channel = 1; channel < 16; channel++){
+        m_shadow[AD7124_CH0_MAP_REG + channel] = 0x0001;
+    }
+    for (int setup = 0; setup < 8; setup++){
+        m_shadow[AD7124_CFG0_REG + setup] = 0x0860;
+        m_shadow[AD7124_FILT0_REG + setup] = 0x060180;
+        m_shadow[AD7124_OFFS0_REG + setup] = 0x800000;
+    }
+
+    // The gain registers hold factory calibration values, which are only known once read
+    m_shadow_known = (uint64_t(1) << REGISTER_COUNT) - 1;
+    for (int setup = 0; setup < 8; setup++){
+        m_shadow_known &= ~(uint64_t(1) << (AD7124_GAIN0_REG + setup));
     }
 }
 
+int AD7124::register_size(uint8_t address){
+    if (address == AD7124_STATUS_REG || address == AD7124_ID_REG || address == 0x08){
+        return 1;
+    }
+    if (address == AD7124_ADC_CTRL_REG || address == AD7124_IO_CTRL2_REG ||
+        (address >= AD7124_CH0_MAP_REG && address < AD7124_FILT0_REG)){
+        return 2;
+    }
+    return 3;
+}
 
-/* channel_reg
- * Sets up the channel registers.
- * Can setup channel 0, or 1, or both depending on flags
+/**
+ * The frames of all changed registers, each a communications byte followed by
+ * the value MSB first, are clocked out back to back in one transaction. The
+ * verification reads the same registers in a second one. A control register
+ * value entering continuous read mode cannot be read back and is not verified.
  */
-void AD7124::channel_reg(char RW){
-    //RW=1 -> read else write
-    if(RW == m_read){
-        m_spi.write(AD7124_R | AD7124_CH1_MAP_REG);
-        TRACE("Channel register =");
-        for (int i = 0; i<=1; i++){
-            int byte = m_spi.write(0x00);
-            TRACE("%s", byte_to_binary(byte).c_str());
+bool AD7124::write_registers(const RegisterValue* registers, std::size_t count, bool verify){
+    MBED_ASSERT(count <= REGISTER_BATCH_SIZE);
+
+    std::size_t written_count = 0;
+    int length = 0;
+
+    for (std::size_t i = 0; i < count; i++){
+        const RegisterValue& reg = registers[i];
+        const uint64_t known = uint64_t(1) << reg.address;
+        if ((m_shadow_known & known) && m_shadow[reg.address] == reg.value){
+            continue;
+        }
+        m_register_tx[length++] = static_cast<char>(AD7124_COMM_REG_WR | AD7124_COMM_REG_RA(reg.address));
+        for (int byte = register_size(reg.address) - 1; byte >= 0; byte--){
+            m_register_tx[length++] = static_cast<char>((reg.value >> (8 * byte)) & 0xFF);
+        }
+        m_shadow[reg.address] = reg.value;
+        m_shadow_known |= known;
+        if (reg.address != AD7124_ADC_CTRL_REG || !(reg.value & AD7124_ADC_CTRL_REG_CONT_READ)){
+            m_register_written[written_count++] = reg;
         }
-        TRACE("\n");
+    }
 
-    } else {
-        // SET CHANNEL 0
-        if(m_flag_0 == true){
-            m_spi.write(AD7124_CH0_MAP_REG);
-            const uint16_t channel_settings = AD7124_CH_MAP_REG_CH_ENABLE | AD7124_CH_MAP_REG_SETUP(0) |
-                                                 AD7124_CH_MAP_REG_AINP(0) |AD7124_CH_MAP_REG_AINM(1);
-            char channel_reg_set_ch0[]={channel_settings>>8 & 0xFF, channel_settings & 0xFF}; //channel 0 and 1 (0x80, 0x01)
-                //0x80 for setup 0
-            for (int i = 0; i<=1; i++){
-                m_spi.write(channel_reg_set_ch0[i]);
-            }
+    if (length == 0){
+        return true;
+    }
+    m_bus.transfer(m_register_tx, m_register_rx, length);
+
+    if (!verify || written_count == 0){
+        return true;
+    }
+
+    for (std::size_t i = 0; i < written_count; i++){
+        m_register_read_back[i].address = m_register_written[i].address;
+    }
+    read_registers(m_register_read_back, written_count);
+
+    bool verified = true;
+    for (std::size_t i = 0; i < written_count; i++){
+        if (m_register_read_back[i].value != m_register_written[i].value){
+            TRACE("AD7124 register 0x%02X reads 0x%06lX instead of 0x%06lX", m_register_written[i].address,
+                static_cast<unsigned long>(m_register_read_back[i].value), static_cast<unsigned long>(m_register_written[i].value));
+            verified = false;
         }
-        // SET CHANNEL 1
-        if(m_flag_1 == true){
-            m_spi.write(AD7124_CH1_MAP_REG);
-            //register bytes set like this -> 10 00 00 (00 - 01 0)(0 00 11)
-            //channel 1 - pins (2) and (3)
-            //x80 is 1st byte, x43 is 2nd byte (for setting the AIN)
-            const uint16_t channel_settings1 = AD7124_CH_MAP_REG_CH_ENABLE | AD7124_CH_MAP_REG_SETUP(1) |
-                                        AD7124_CH_MAP_REG_AINP(2) |AD7124_CH_MAP_REG_AINM(3);
-
-            char channel_reg_set_ch1[]={channel_settings1>>8 & 0xFF, channel_settings1 & 0xFF}; //channel 2 and 3 (0x90, 0x43)
-                //0x90 for setup 1
-            for (int i = 0; i<=1; i++){
-                m_spi.write(channel_reg_set_ch1[i]);
-            }
+    }
+    return verified;
+}
+
+/**
+ * All registers are read in one transaction, the shadow takes the values read.
+ */
+void AD7124::read_registers(RegisterValue* registers, std::size_t count){
+    MBED_ASSERT(count <= REGISTER_BATCH_SIZE);
+
+    int length = 0;
+    for (std::size_t i = 0; i < count; i++){
+        m_register_tx[length++] = static_cast<char>(AD7124_COMM_REG_RD | AD7124_COMM_REG_RA(registers[i].address));
+        for (int byte = 0; byte < register_size(registers[i].address); byte++){
+            m_register_tx[length++] = 0x00;
+        }
+    }
+    if (length == 0){
+        return;
+    }
+    m_bus.transfer(m_register_tx, m_register_rx, length);
+
+    int position = 0;
+    for (std::size_t i = 0; i < count; i++){
+        position++; // Communications byte
+        uint32_t value = 0;
+        for (int byte = 0; byte < register_size(registers[i].address); byte++){
+            value = (value << 8) | static_cast<uint8_t>(m_register_rx[position++]);
+        }
+        registers[i].value = value;
+        if (registers[i].address != AD7124_STATUS_REG && registers[i].address != AD7124_DATA_REG){
+            m_shadow[registers[i].address] = value;
+            m_shadow_known |= uint64_t(1) << registers[i].address;
         }
     }
 }
 
-void AD7124::filter_reg(uint8_t filt, char RW){
-    //default FS: 384, Post filter = 011
-    if(RW == m_read){
-        m_spi.write(AD7124_R | filt);
-        TRACE("Filter register =");
-        for (int i = 0; i<=2; i++){
-            int byte = m_spi.write(0x00);
-            TRACE("%s", byte_to_binary(byte).c_str());
+/**
+ * In continuous read mode every SCLK burst returns conversion data. The mode is
+ * left by sending the read data command while DOUT/RDY is low, after which the
+ * pending conversion is clocked out and discarded.
+ */
+bool AD7124::wait_for_drdy(std::chrono::milliseconds timeout){
+    // Poll at the kernel tick, settling and calibration take milliseconds to seconds
+    // and the thread must not keep the MCU awake meanwhile
+    const rtos::Kernel::Clock::time_point deadline = rtos::Kernel::Clock::now() + timeout;
+    while (m_bus.read_drdy() == 1){
+        if (rtos::Kernel::Clock::now() > deadline){
+            return false;
         }
-        TRACE("\n");
-    }
-    else{
-        m_spi.write(filt);
-        //char contr_reg_set[]={0x00,0x08};
-        //char filter_reg_set[]={AD7124_FILT_REG_FILTER(4)>>16,0x00,0x40};
-        char filter_reg_set[]={0x00, 0x00, 0x00}; //0x00,0x12,0xC0 for testing
-        for (int i = 0; i<=2; i++){
-            m_spi.write(filter_reg_set[i]);
+        ThisThread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+bool AD7124::exit_continuous_read(void){
+    // Wait for at most one settling time of the slowest setup plus margin
+    if (!wait_for_drdy(std::chrono::milliseconds(500))){
+        m_shadow_known = 0; // The device state is unknown, write everything next time
+        return false;
+    }
+
+    char tx[5] = {static_cast<char>(AD7124_COMM_REG_RD | AD7124_COMM_REG_RA(AD7124_DATA_REG)), 0, 0, 0, 0};
+    char rx[5];
+    m_bus.transfer(tx, rx, 5);
+    m_shadow[AD7124_ADC_CTRL_REG] &= ~AD7124_ADC_CTRL_REG_CONT_READ;
+    return true;
+}
+
+/**
+ * @brief Masks the DRDY interrupt, lets a conversion read in flight finish and leaves continuous read mode.
+ */
+bool AD7124::pause_acquisition(void){
+    m_acquisition_paused = true;
+    m_bus.disable_drdy_irq();
+    while (m_conversion_in_flight){
+        ThisThread::yield();
+    }
+    return exit_continuous_read();
+}
+
+/**
+ * @brief Unmasks the DRDY interrupt again once continuous read mode has been entered.
+ */
+void AD7124::resume_acquisition(void){
+    m_acquisition_paused = false;
+    if (m_acquisition_running){
+        m_bus.enable_drdy_irq();
+        if (m_bus.read_drdy() == 0){
+            m_bus.disable_drdy_irq();
+            request_read();
+        }
+    }
+}
+
+/**
+ * @brief Writes the setups and the control register that differ from the shadow.
+ *
+ * Unchanged configurations return at once without touching the device. Otherwise
+ * the DRDY interrupt is masked for the whole update and an asynchronous conversion
+ * read still in flight is allowed to finish first. Without verification the
+ * changed registers and the control register entering continuous read mode go out
+ * in a single transaction.
+ */
+bool AD7124::apply_configuration(const Configuration& configuration, bool verify){
+    RegisterValue registers[REGISTER_BATCH_SIZE];
+    std::size_t count = 0;
+    for (int setup = 0; setup < ADC_CHANNELS; setup++){
+        registers[count++] = {static_cast<uint8_t>(AD7124_CFG0_REG + setup), config_register_value(configuration.setups[setup])};
+        registers[count++] = {static_cast<uint8_t>(AD7124_FILT0_REG + setup), filter_register_value(configuration.setups[setup])};
+    }
+    const uint16_t control = control_register_value(configuration.power_mode);
+
+    bool changed = !(m_shadow_known & (uint64_t(1) << AD7124_ADC_CTRL_REG)) || m_shadow[AD7124_ADC_CTRL_REG] != control;
+    for (std::size_t i = 0; i < count && !changed; i++){
+        changed = !(m_shadow_known & (uint64_t(1) << registers[i].address)) || m_shadow[registers[i].address] != registers[i].value;
+    }
+    if (!changed){
+        m_configuration = configuration;
+        return true;
+    }
+
+    bool verified = pause_acquisition();
+    m_configuration = configuration;
+    m_expected_gap_us = static_cast<uint32_t>(1e6f / get_channel_data_rate() + 0.5f);
+
+    if (verify){
+        // Control register without continuous read, so the read back is possible
+        registers[count++] = {AD7124_ADC_CTRL_REG, static_cast<uint32_t>(control & ~AD7124_ADC_CTRL_REG_CONT_READ)};
+        verified = write_registers(registers, count, true) && verified;
+        count = 0;
+    }
+
+    // Entering continuous read mode again restarts conversions with the new setups
+    registers[count++] = {AD7124_ADC_CTRL_REG, control};
+    write_registers(registers, count, false);
+
+    if (!verified){
+        ERROR("AD7124 configuration could not be verified");
+    }
+
+    resume_acquisition();
+    return verified;
+}
+
+bool AD7124::configure(const Configuration& configuration, bool verify){
+    if (!m_acquisition_running){
+        return apply_configuration(configuration, verify);
+    }
+
+#ifdef COOPERATIVE_SCHEDULING
+    // The conversion reads are handlers of the same loop, none runs meanwhile
+    return apply_configuration(configuration, verify);
+#else
+    // Run on the DRDY thread, so the update is serialised with the conversion reads
+    bool verified = false;
+    Semaphore done(0);
+    int id = m_drdy_queue.call([this, &configuration, verify, &verified, &done]() {
+        verified = apply_configuration(configuration, verify);
+        done.release();
+    });
+    if (id == 0){
+        return false;
+    }
+    done.acquire();
+    return verified;
+#endif
+}
+
+/**
+ * Converts the internal temperature sensor once on channel 15 with setup 7 at
+ * gain 1, which the sensor requires. Channels and setup 7 are restored from the
+ * shadow afterwards; the caller writes the control register.
+ */
+float AD7124::measure_temperature(void){
+    RegisterValue saved[ADC_CHANNELS + 3];
+    std::size_t count = 0;
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        saved[count++] = {static_cast<uint8_t>(AD7124_CH0_MAP_REG + channel), m_shadow[AD7124_CH0_MAP_REG + channel]};
+    }
+    saved[count++] = {AD7124_CH15_MAP_REG, m_shadow[AD7124_CH15_MAP_REG]};
+    saved[count++] = {AD7124_CFG7_REG, m_shadow[AD7124_CFG7_REG]};
+    saved[count++] = {AD7124_FILT7_REG, m_shadow[AD7124_FILT7_REG]};
+
+    RegisterValue registers[ADC_CHANNELS + 4];
+    for (std::size_t i = 0; i < count; i++){
+        registers[i] = saved[i];
+    }
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        registers[channel].value &= ~AD7124_CH_MAP_REG_CH_ENABLE;
+    }
+    registers[ADC_CHANNELS].value = AD7124_CH_MAP_REG_CH_ENABLE | AD7124_CH_MAP_REG_SETUP(7) |
+                                    AD7124_CH_MAP_REG_AINP(16) | AD7124_CH_MAP_REG_AINM(17); // Sensor against AVSS
+    registers[ADC_CHANNELS + 1].value = AD7124_CFG_REG_BIPOLAR | AD7124_CFG_REG_REF_SEL(2) | AD7124_CFG_REG_PGA(0);
+    registers[ADC_CHANNELS + 2].value = m_shadow[AD7124_FILT0_REG];
+    // Single conversion without the status byte
+    const uint16_t control = control_register_value(m_configuration.power_mode);
+    registers[count] = {AD7124_ADC_CTRL_REG, static_cast<uint32_t>((control & ~(AD7124_ADC_CTRL_REG_CONT_READ |
+                        AD7124_ADC_CTRL_REG_DATA_STATUS | AD7124_ADC_CTRL_REG_MODE(0xF))) | AD7124_ADC_CTRL_REG_MODE(1))};
+    write_registers(registers, count + 1, false);
+
+    float temperature = NAN;
+    const auto timeout = std::chrono::milliseconds(static_cast<int>(get_settling_time(0) * 2000.0f) + 100);
+    if (wait_for_drdy(timeout)){
+        RegisterValue data = {AD7124_DATA_REG, 0};
+        read_registers(&data, 1);
+        temperature = (static_cast<int32_t>(data.value) - 0x800000) / 13584.0f - 272.5f;
+    }
+    // The converter is in standby afterwards
+    m_shadow_known &= ~(uint64_t(1) << AD7124_ADC_CTRL_REG);
+
+    write_registers(saved, count, false);
+    return temperature;
+}
+
+/**
+ * Internal full-scale calibration (not available at gain 1, where the factory
+ * gain applies) followed by an internal zero-scale calibration, with only the
+ * channel of the setup enabled. Each calibration ends with DOUT/RDY low and the
+ * converter idle.
+ */
+bool AD7124::calibrate_setup(int setup){
+    const uint16_t control = control_register_value(m_configuration.power_mode) &
+                             ~(AD7124_ADC_CTRL_REG_CONT_READ | AD7124_ADC_CTRL_REG_MODE(0xF));
+    const auto timeout = std::chrono::milliseconds(static_cast<int>(get_settling_time(setup) * 8000.0f) + 100);
+
+    RegisterValue registers[ADC_CHANNELS + 1];
+    std::size_t count = 0;
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        uint32_t value = channel_register_value(channel);
+        if (channel != setup){
+            value &= ~AD7124_CH_MAP_REG_CH_ENABLE;
+        }
+        registers[count++] = {static_cast<uint8_t>(AD7124_CH0_MAP_REG + channel), value};
+    }
+    registers[count++] = {static_cast<uint8_t>(AD7124_OFFS0_REG + setup), 0x800000};
+    write_registers(registers, count, false);
+
+    bool calibrated = true;
+    const uint32_t modes[2] = {6, 5}; // Internal full-scale, internal zero-scale
+    for (uint32_t mode : modes){
+        if (mode == 6 && m_configuration.setups[setup].gain == PgaGain::x1){
+            continue;
         }
+        RegisterValue start = {AD7124_ADC_CTRL_REG, static_cast<uint32_t>(control | AD7124_ADC_CTRL_REG_MODE(mode))};
+        write_registers(&start, 1, false);
+        calibrated = wait_for_drdy(timeout) && calibrated;
+        m_shadow_known &= ~(uint64_t(1) << AD7124_ADC_CTRL_REG); // Idle now
     }
+    return calibrated;
 }
-void AD7124::config_reg(uint8_t address ,char RW){
-    /* read/ write the configuration register */
-    if(RW == m_read){
-        m_spi.write(AD7124_R | address);
-        TRACE("ADC conf = ");
-        for (int i = 0; i<=1; i++){
-            int byte = m_spi.write(0x00);
-            TRACE("%s", byte_to_binary(byte).c_str());
+
+bool AD7124::run_calibration(CalibrationStore& store, float temperature_delta, bool force){
+    bool calibrated = pause_acquisition();
+    const float temperature = measure_temperature();
+
+    // Calibration depends on gain, filter and power mode, so it only applies to the same setups
+    CalibrationStore::Record record;
+    const uint16_t power_mode = AD7124_ADC_CTRL_REG_POWER_MODE(static_cast<uint16_t>(m_configuration.power_mode));
+    bool valid = !force && store.load(record) && record.setups == ADC_CHANNELS && record.control == power_mode &&
+                 std::fabs(record.temperature - temperature) <= temperature_delta;
+    for (int setup = 0; setup < ADC_CHANNELS && valid; setup++){
+        valid = record.config[setup] == config_register_value(m_configuration.setups[setup]) &&
+                record.filter[setup] == filter_register_value(m_configuration.setups[setup]);
+    }
+
+    RegisterValue registers[REGISTER_BATCH_SIZE];
+    std::size_t count = 0;
+    if (valid){
+        for (int setup = 0; setup < ADC_CHANNELS; setup++){
+            registers[count++] = {static_cast<uint8_t>(AD7124_OFFS0_REG + setup), record.offset[setup]};
+            registers[count++] = {static_cast<uint8_t>(AD7124_GAIN0_REG + setup), record.gain[setup]};
         }
-        TRACE("\n");
+        calibrated = write_registers(registers, count, true) && calibrated;
+        INFO("ADC calibration restored (calibrated at %d.%d C, now %d.%d C)",
+            static_cast<int>(record.temperature), static_cast<int>(std::fabs(record.temperature) * 10) % 10,
+            static_cast<int>(temperature), static_cast<int>(std::fabs(temperature) * 10) % 10);
+    } else {
+        for (int setup = 0; setup < ADC_CHANNELS; setup++){
+            calibrated = calibrate_setup(setup) && calibrated;
+            registers[count++] = {static_cast<uint8_t>(AD7124_OFFS0_REG + setup), 0};
+            registers[count++] = {static_cast<uint8_t>(AD7124_GAIN0_REG + setup), 0};
+        }
+        read_registers(registers, count);
+
+        record.temperature = temperature;
+        record.control = power_mode;
+        record.setups = ADC_CHANNELS;
+        for (int setup = 0; setup < CalibrationStore::SETUPS; setup++){
+            const bool used = setup < ADC_CHANNELS;
+            record.config[setup] = used ? config_register_value(m_configuration.setups[setup]) : 0;
+            record.filter[setup] = used ? filter_register_value(m_configuration.setups[setup]) : 0;
+            record.offset[setup] = used ? registers[2 * setup].value : 0;
+            record.gain[setup] = used ? registers[2 * setup + 1].value : 0;
+        }
+        if (calibrated && !store.save(record)){
+            WARN("ADC calibration could not be stored");
+        }
+        INFO("ADC calibrated at %d.%d C", static_cast<int>(temperature), static_cast<int>(std::fabs(temperature) * 10) % 10);
+    }
+
+    // All channels again, then continuous conversion and read
+    count = 0;
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        registers[count++] = {static_cast<uint8_t>(AD7124_CH0_MAP_REG + channel), channel_register_value(channel)};
     }
-    else{
-        m_spi.write(address);
-        char my_config[]={(AD7124_CFG_REG_BIPOLAR ) >>8 ,
-                          AD7124_CFG_REG_AIN_BUFP | AD7124_CFG_REG_AINN_BUFM | AD7124_CFG_REG_REF_SEL(2) |AD7124_CFG_REG_PGA(2)};
-        //original 0x08, 0x71
-        for (int i = 0; i<=1; i++){
-            m_spi.write(my_config[i]);
-        } 
+    registers[count++] = {AD7124_ADC_CTRL_REG, control_register_value(m_configuration.power_mode)};
+    write_registers(registers, count, false);
+
+    if (!calibrated){
+        ERROR("AD7124 calibration failed");
     }
+    resume_acquisition();
+    return calibrated;
+}
+
+bool AD7124::calibrate(CalibrationStore& store, float temperature_delta, bool force){
+    if (!m_acquisition_running){
+        return run_calibration(store, temperature_delta, force);
+    }
+
+#ifdef COOPERATIVE_SCHEDULING
+    // The conversion reads are handlers of the same loop, none runs meanwhile
+    return run_calibration(store, temperature_delta, force);
+#else
+    // Run on the DRDY thread, so the calibration is serialised with the conversion reads
+    bool calibrated = false;
+    Semaphore done(0);
+    int id = m_drdy_queue.call([this, &store, temperature_delta, force, &calibrated, &done]() {
+        calibrated = run_calibration(store, temperature_delta, force);
+        done.release();
+    });
+    if (id == 0){
+        return false;
+    }
+    done.acquire();
+    return calibrated;
+#endif
+}
+
+const AD7124::Configuration& AD7124::get_configuration(void) const{
+    return m_configuration;
+}
+
+float AD7124::get_output_data_rate(int setup) const{
+    const SetupConfig& config = m_configuration.setups[setup];
+    const float f_clk = (m_configuration.power_mode == PowerMode::Full) ? 614400.0f :
+                        (m_configuration.power_mode == PowerMode::Mid) ? 153600.0f : 76800.0f;
+    const float fs = static_cast<float>(config.filter_select);
+    // Averaging of the fast settling filters
+    const float average = (m_configuration.power_mode == PowerMode::Low) ? 8.0f : 16.0f;
+
+    switch (config.filter){
+        case FilterType::Sinc4:
+        case FilterType::Sinc3:
+            return f_clk / (32.0f * fs);
+        case FilterType::FastSinc4:
+            return f_clk / (32.0f * fs * (4.0f + average - 1.0f));
+        case FilterType::FastSinc3:
+            return f_clk / (32.0f * fs * (3.0f + average - 1.0f));
+        case FilterType::PostFilter:
+        default:
+            switch (config.post_filter){
+                case PostFilter::Sps27: return 27.27f;
+                case PostFilter::Sps25: return 25.0f;
+                case PostFilter::Sps20: return 20.0f;
+                case PostFilter::Sps16:
+                default: return 16.67f;
+            }
+    }
+}
+
+float AD7124::get_settling_time(int setup) const{
+    const SetupConfig& config = m_configuration.setups[setup];
+    const float period = 1.0f / get_output_data_rate(setup);
+    switch (config.filter){
+        case FilterType::Sinc4:
+            return 4.0f * period;
+        case FilterType::Sinc3:
+            return 3.0f * period;
+        case FilterType::PostFilter:
+            // Settling times of the post filters from the data sheet
+            switch (config.post_filter){
+                case PostFilter::Sps27: return 0.04154f;
+                case PostFilter::Sps25: return 0.04440f;
+                case PostFilter::Sps20: return 0.05220f;
+                case PostFilter::Sps16:
+                default: return 0.06130f;
+            }
+        case FilterType::FastSinc4:
+        case FilterType::FastSinc3:
+        default:
+            return period;
+    }
+}
+
+float AD7124::get_channel_data_rate(void) const{
+    // The sequencer converts every channel once per cycle, each conversion fully settled
+    float cycle = 0.0f;
+    for (int setup = 0; setup < ADC_CHANNELS; setup++){
+        cycle += get_settling_time(setup);
+    }
+    return 1.0f / cycle;
 }
 
 void AD7124::reset(){
-    /* reset the ADC */
+    /* reset the ADC with 64 ones */
     //INFO("Reset ADC\n");
-    for (int i = 0; i< 8; i++){
-        m_spi.write(0xFF);
-    }
+    char tx[8] = {'\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF'};
+    char rx[8];
+    m_bus.transfer(tx, rx, 8);
+    reset_shadow();
 }
 
 char AD7124::status(){
-    /* read the status register */
-    m_spi.write(AD7124_R | AD7124_STATUS_REG);
-    char status = m_spi.write(0x00); 
+    /* read the status register, command and data in one transaction so a shared bus cannot split them */
+    char tx[2] = {static_cast<char>(AD7124_R | AD7124_STATUS_REG), 0x00};
+    char rx[2];
+    m_bus.transfer(tx, rx, 2);
+    char status = rx[1];
     TRACE("ADC status = 0x%X, %s\n", status, byte_to_binary(status).c_str());
     return status;
 }
 
-void AD7124::init(bool f0, bool f1){
-    m_flag_0 = f0;
-    m_flag_1 = f1;
-    m_sync = 1;
-    m_cs=0;
+void AD7124::init(void){
+    m_bus.set_sync(1);
+    m_bus.set_cs(0);
 
     reset();
     status();
 
-    channel_reg(m_read); //activate 2 channels
-    channel_reg(m_write); //activate 2 channels
-    channel_reg(m_read); //activate 2 channels
-
-//flags for if you want to have channel 0, or 1, or both active
-    if(m_flag_0 == true){
-        //config reg 0
-        config_reg(AD7124_CFG0_REG, m_read);   // read  configuration register
-        config_reg(AD7124_CFG0_REG, m_write);  // write configuration register
-        config_reg(AD7124_CFG0_REG, m_read);   // proof writing by reading again
-        //filter reg 0
-        filter_reg(AD7124_FILT0_REG, m_read);  // same with filter register
-        filter_reg(AD7124_FILT0_REG, m_write);
-        filter_reg(AD7124_FILT0_REG, m_read);
+    // Channels 0 to ADC_CHANNELS - 1 with one setup each, written in one transaction and verified in another
+    RegisterValue registers[REGISTER_BATCH_SIZE];
+    std::size_t count = 0;
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        registers[count++] = {static_cast<uint8_t>(AD7124_CH0_MAP_REG + channel), channel_register_value(channel)};
     }
-
-    if(m_flag_1 == true){
-        //config reg 1
-        //AD7124::config_reg(AD7124_CFG1_REG, read);
-        config_reg(AD7124_CFG1_REG, m_write);
-        config_reg(AD7124_CFG1_REG, m_read);
-        //filter reg 1
-        //AD7124::filter_reg(AD7124_FILT1_REG, read);
-        filter_reg(AD7124_FILT1_REG, m_write);
-        filter_reg(AD7124_FILT1_REG, m_read);
+    for (int setup = 0; setup < ADC_CHANNELS; setup++){
+        registers[count++] = {static_cast<uint8_t>(AD7124_CFG0_REG + setup), config_register_value(m_configuration.setups[setup])};
+        registers[count++] = {static_cast<uint8_t>(AD7124_FILT0_REG + setup), filter_register_value(m_configuration.setups[setup])};
+    }
+    const uint16_t control = control_register_value(m_configuration.power_mode);
+    registers[count++] = {AD7124_ADC_CTRL_REG, static_cast<uint32_t>(control & ~AD7124_ADC_CTRL_REG_CONT_READ)};
+    if (!write_registers(registers, count, true)){
+        ERROR("AD7124 registers could not be verified");
     }
-    //xAD7124::calibrate(1,1,0,0);
 
-    ctrl_reg(m_read);     // same with control register
-    ctrl_reg(m_write);
-    ctrl_reg(m_read);
-    //AD7124::calibrate(1,0,0,0);
+    registers[0] = {AD7124_ADC_CTRL_REG, control};
+    write_registers(registers, 1, false);
 }
 
 /**
- * @brief Constructs an AD7124 object and initializes SPI communication.
- * @param spi_frequency The SPI clock frequency in Hz.
+ * @brief Constructs an AD7124 object on the given bus.
+ * @param bus The SPI bus and DOUT/RDY line of the converter.
+ * @param device Number of the converter.
  */
-AD7124::AD7124(int spi_frequency):
-    m_spi(PA_7, PA_6, PA_5), m_drdy(PA_6), m_cs(PA_4), m_sync(PA_1),
-    m_spi_frequency(spi_frequency), m_flag_0(false), m_flag_1(false),
-    m_read(1), m_write(0){
+AD7124::AD7124(AD7124Bus& bus, uint8_t device):
+    m_bus(bus), m_device(device), m_shadow_known(0),
+#ifdef COOPERATIVE_SCHEDULING
+    m_block_posted(false), m_parked(false),
+#else
+    m_drdy_queue(DRDY_QUEUE_EVENTS * EVENTS_EVENT_SIZE),
+    m_drdy_thread(osPriorityRealtime, DRDY_THREAD_STACK_SIZE, nullptr, "adc_drdy"),
+#endif
+    m_acquisition_running(false), m_acquisition_paused(false), m_conversion_in_flight(false),
+    m_read_requested(false), m_async_reads(true), m_window_settings_changed(true), m_reported_overflows(0), m_held_back(false){
+
+    // Default: low power, sinc4 with FS = 6 (400 SPS, 50 conversions per second and channel), gain 4
+    m_configuration.power_mode = PowerMode::Low;
+    for (int setup = 0; setup < ADC_CHANNELS; setup++){
+        m_configuration.setups[setup] = {FilterType::Sinc4, 6, PostFilter::Sps25, false, false, PgaGain::x4};
+    }
+
+    for (int j = 0; j < 4; j++){
+        m_conversion_tx[j] = 0x00;
+        m_conversion_rx[j] = 0x00;
+    }
+
+    m_drdy_timestamp = 0;
 
-    m_spi.format(8, 3);           
-    m_spi.frequency(m_spi_frequency);
+#ifdef COOPERATIVE_SCHEDULING
+    MBED_ASSERT(device < ADC_DEVICES);
+    s_converters[device] = this;
+#else
+    static_assert(DRDY_THREAD_STACK_SIZE >= DRDY_THREAD_BASE_STACK_SIZE + DRDY_THREAD_FRAME_SIZE && DRDY_THREAD_STACK_SIZE % 8 == 0,
+                  "The DRDY thread must hold the register batches of configure() and calibrate()");
+#endif
+
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        m_window_settings[channel] = {VECTOR_SIZE, 1};
+        m_new_values[channel] = 0;
+        m_hops[channel] = 1;
+    }
+    m_expected_gap_us = static_cast<uint32_t>(1e6f / get_channel_data_rate() + 0.5f);
 
-    init(true,true);
+    // DRDY shares its pin with MISO, so the interrupt stays masked until acquisition starts.
+    m_bus.disable_drdy_irq();
+
+    init();
 }
 
 /**
@@ -200,128 +645,397 @@ AD7124::AD7124(int spi_frequency):
  * @return Reference to the singleton instance of the AD7124 class.
  */
 AD7124& AD7124::getInstance(int spi_frequency) {
-    static AD7124 instance(spi_frequency);
+    static MbedAD7124Bus::Lines lines(spi_frequency);
+    static MbedAD7124Bus bus(lines);
+    return getInstance(bus);
+}
+
+/**
+ * @brief Gets the singleton instance of the AD7124 class on the given bus.
+ * @param bus The bus used if this call creates the instance, e.g. a SimulatedAD7124.
+ * @return Reference to the singleton instance of the AD7124 class.
+ */
+AD7124& AD7124::getInstance(AD7124Bus& bus) {
+    static AD7124 instance(bus);
     return instance;
 }
 
+uint8_t AD7124::get_device(void) const{
+    return m_device;
+}
+
 
 /**
  * @brief Sends ADC data to the main thread for further processing.
- * @param byte_inputs_channel_0 Data from channel 0.
- * @param byte_inputs_channel_1 Data from channel 1.
+ * @param byte_inputs Window of every channel.
  */
-void AD7124::send_data_to_main_thread(
-    std::vector<std::array<uint8_t, 3>> byte_inputs_channel_0,
-    std::vector<std::array<uint8_t, 3>> byte_inputs_channel_1)
-{   
-    // Acquire the mutex before accessing the shared mailbox.
-    reading_mutex.lock();
-
+void AD7124::send_data_to_main_thread(const ByteWindow (&byte_inputs)[ADC_CHANNELS],
+                                      const uint16_t (&new_values)[ADC_CHANNELS])
+{
     // Access the shared queue
     ReadingQueue& reading_queue = ReadingQueue::getInstance();
 
-    // Check and wait until the mailbox is empty before putting new mail.
-    while (!reading_queue.mail_box.empty()) {
-        reading_mutex.unlock();
-        thread_sleep_for(1);// Allow the consumer to catch up.
-        reading_mutex.lock();
+    // The pool holds a buffer for every converter beyond the full queues, so the allocation
+    // only waits while a Block edge downstream holds the pipeline.
+    WindowPool::Buffer* window = WindowPool::getInstance().alloc();
+    if (window) {  // Check in case allocation fails.
+        // Linearise the windows, oldest value first, straight into the pooled buffer. This is
+        // the only copy of a window, later stages work on the buffer in place.
+        for (int channel = 0; channel < ADC_CHANNELS; channel++){
+            byte_inputs[channel].copy_to(window->inputs[channel].data());
+            window->lengths[channel] = static_cast<uint16_t>(byte_inputs[channel].size());
+            window->new_values[channel] = new_values[channel];
+        }
+        window->device = m_device;
+        reading_queue.queue.put(window);
     }
+}
+
+
+/**
+ * @brief Handles the falling edge of DOUT/RDY.
+ *
+ * DOUT/RDY doubles as MISO, so the interrupt is masked until the read is done.
+ * A blocking SPI transfer cannot run in interrupt context, so without an
+ * asynchronous bus the read runs as an event on the high priority DRDY thread.
+ */
+void AD7124::drdy_isr(void){
+    m_bus.disable_drdy_irq();
+    request_read();
+}
 
-    // Now, when the mailbox is empty, allocate a new mail slot.
-    ReadingQueue::mail_t* mail = reading_queue.mail_box.try_alloc_for(rtos::Kernel::Clock::duration_u32::max());
-    if (mail) {  // Check in case allocation fails.
-        // Here you are assigning to the mail contents.
-        // NOTE: Make sure that ReadingQueue::mail_t's members are properly initialized.
-        // For example, if mail_t contains std::vector objects, their constructors should have been called.
-        std::copy(byte_inputs_channel_0.begin(), byte_inputs_channel_0.end(), mail->inputs_ch0.begin());
-        std::copy(byte_inputs_channel_1.begin(), byte_inputs_channel_1.end(), mail->inputs_ch1.begin());
-        reading_queue.mail_box.put(mail);
+/**
+ * @brief Starts the read of a conversion unless a read is already pending. Called
+ * with the DRDY interrupt masked, from the edge handler or after a level check.
+ *
+ * An edge right after unmasking and the level check that follows may both find the
+ * conversion ready, but only one read is scheduled for it. If the bus transfers
+ * asynchronously, the read is queued on it right here, so it overlaps with the
+ * processing of the previous block and needs no thread. Otherwise read_conversion()
+ * is posted to the DRDY thread, or to the EventLoop with COOPERATIVE_SCHEDULING.
+ */
+void AD7124::request_read(void){
+    if (m_read_requested.exchange(true)){
+        return;
+    }
+    m_drdy_timestamp = m_bus.get_time_us();
+    if (m_async_reads && start_conversion_read()){
+        return;
     }
+#ifdef COOPERATIVE_SCHEDULING
+    if (!EventLoop::getInstance().post(callback(this, &AD7124::read_conversion))){
+#else
+    if (m_drdy_queue.call(callback(this, &AD7124::read_conversion)) == 0){
+#endif
+        m_read_requested = false;
+        m_bus.enable_drdy_irq(); // Queue full, wait for the next edge
+    }
+}
 
-    reading_mutex.unlock();
+/**
+ * @brief Queues the asynchronous read of one conversion (data and appended status byte).
+ *
+ * All four bytes are clocked in one SPI transaction, by DMA on the board, and
+ * conversion_complete() is called from its completion. May run in interrupt context.
+ */
+bool AD7124::start_conversion_read(void){
+    // In flight before the pause is checked: pause_acquisition() sets the pause before it
+    // waits for reads in flight, so either it waits for this read or the read sees the pause.
+    m_conversion_in_flight = true;
+
+    // Configuration owns the bus, it restarts the reads when done.
+    if (m_acquisition_paused){
+        m_conversion_in_flight = false;
+        m_read_requested = false;
+        return true;
+    }
+
+    // An edge caused by SPI traffic on the shared line is not a conversion.
+    if (m_bus.read_drdy() == 1){
+        m_conversion_in_flight = false;
+        m_read_requested = false;
+        m_bus.enable_drdy_irq();
+        return true;
+    }
+
+    // m_read_requested stays set until the read completes, a level check on the
+    // way cannot start a second one.
+    if (m_bus.transfer_async(m_conversion_tx, m_conversion_rx, sizeof(m_conversion_rx),
+                             callback(this, &AD7124::conversion_complete)) == 0){
+        return true;
+    }
+    m_conversion_in_flight = false;
+    m_async_reads = false;
+    return false;
 }
 
+/**
+ * @brief Reads one conversion in a blocking transaction on the DRDY thread, used
+ * if the bus cannot transfer asynchronously.
+ */
+void AD7124::read_conversion(void){
+    m_read_requested = false;
+
+    // In flight before the pause is checked, as in start_conversion_read()
+    m_conversion_in_flight = true;
+    if (m_acquisition_paused){
+        m_conversion_in_flight = false;
+        return;
+    }
+    if (m_bus.read_drdy() == 1){
+        m_conversion_in_flight = false;
+        m_bus.enable_drdy_irq();
+        return;
+    }
+
+    m_bus.transfer(m_conversion_tx, m_conversion_rx, sizeof(m_conversion_rx));
+    conversion_complete(0);
+}
 
 /**
- * @brief Reads voltage data from both ADC channels with downsampling.
- * @param downsampling_rate The rate to downsample ADC readings (in ms). E.g.
- * @param vector_size The size of the resulting data vectors.
+ * @brief Pushes the conversion held in m_conversion_rx into the ring.
+ *
+ * The acquisition thread is woken, or run_block() posted, once a block of conversions is buffered. If
+ * the ring is full, the conversion is dropped and counted by the ring.
+ * May run in interrupt context.
  */
-void AD7124::read_voltage_from_both_channels(unsigned int downsampling_rate, unsigned int vector_size){
+void AD7124::conversion_complete(int event){
+    uint8_t data[4] = {0, 0, 0, 255};
+    for(int j = 0; j < 4; j++){
+        data[j] = static_cast<uint8_t>(m_conversion_rx[j]);
+    }
+    // Taken before unmasking, the next edge overwrites m_drdy_timestamp.
+    const uint32_t timestamp = m_drdy_timestamp;
+
+    m_conversion_in_flight = false;
+    m_read_requested = false;
 
-    const float collection_interval = static_cast<float>(downsampling_rate) / vector_size;
-    const uint32_t collection_interval_ms = static_cast<uint32_t>(collection_interval * 1000);
+    if (!m_acquisition_paused){
+        m_bus.enable_drdy_irq();
+        // The next conversion may have become ready before the interrupt was unmasked.
+        if (m_bus.read_drdy() == 0){
+            m_bus.disable_drdy_irq();
+            request_read();
+        }
+    }
+
+    if (event & AD7124Bus::TRANSFER_ERROR){
+        return;
+    }
+
+    const int channel = AD7124_STATUS_REG_CH_ACTIVE(data[3]);
+    if (channel >= ADC_CHANNELS){
+        return;
+    }
+
+    std::array<uint8_t, 3> new_bytes = {data[0], data[1], data[2]};
+    RawConversion conversion = {timestamp, bytes_to_signed_code(new_bytes), static_cast<uint8_t>(channel)};
+
+    if (m_conversions.push(conversion) && m_conversions.size() >= ACQUISITION_BLOCK_SIZE){
+#ifdef COOPERATIVE_SCHEDULING
+        schedule_block();
+#else
+        m_block_ready.set(1);
+#endif
+    }
+}
 
-    std::vector<std::array<uint8_t,3>> byte_inputs_channel_0;
-    std::vector<std::array<uint8_t,3>> byte_inputs_channel_1;
+/**
+ * @brief Reads voltage data from all ADC channels with downsampling.
+ * @param decimation_ratio Number of conversions per channel that are decimated into one
+ * window value. E.g. 300 at 50 conversions per second and channel gives one value every 6 s.
+ * @param median_window Length of the spike rejecting median in front of the decimator.
+ * @param spike_threshold Hampel threshold in codes, 0 for a plain median.
+ *
+ * The thread sleeps until the DRDY handler has buffered a block of conversions,
+ * so it does not spin between conversions and the MCU can sleep. With
+ * COOPERATIVE_SCHEDULING the DRDY handler posts the blocks to the EventLoop instead
+ * and this returns at once.
+ */
+void AD7124::read_voltage_from_channels(unsigned int decimation_ratio, unsigned int median_window,
+                                        int32_t spike_threshold){
 
-    bool circular_buffer_triggered_0 = false;
-    bool circular_buffer_triggered_1 = false;
+    start_acquisition(decimation_ratio, median_window, spike_threshold);
 
+#ifndef COOPERATIVE_SCHEDULING
     while (true){ // Collect values forever
 
-        OnlineMean online_mean_ch0;
-        OnlineMean online_mean_ch1;
-            
-        auto start_time = rtos::Kernel::Clock::now();
-                        
-        while (std::chrono::duration_cast<std::chrono::milliseconds>(rtos::Kernel::Clock::now() - start_time).count() < collection_interval_ms){
-            //printf("%lld, %d, %d\n",timer.elapsed_time().count(), collection_interval_ms, counter);
+        // Drain whatever is buffered, then wait for the next block
+        if (!process_block()){
+            m_block_ready.wait_any(1);
+        }
+    }
+#endif
+}
 
-            while(m_drdy == 0){
-                 wait_us(1);
-            }
-            while(m_drdy == 1){
-                wait_us(1);
-            }
+void AD7124::start_acquisition(unsigned int decimation_ratio, unsigned int median_window, int32_t spike_threshold){
+    m_medians.clear();
+    m_decimators.clear();
+    m_medians.reserve(ADC_CHANNELS);
+    m_decimators.reserve(ADC_CHANNELS);
+    m_held_back = false;
 
-            uint8_t data[4] = {0, 0, 0, 255};
-            for(int j = 0; j < 4; j++){
-                // Sends 0x00 and simultaneously receives a byte from the SPI slave device.
-                data[j] = m_spi.write(0x00);
-            }
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        m_new_values[channel] = 0;
+        m_medians.emplace_back(median_window, spike_threshold);
+        m_decimators.emplace_back(decimation_ratio);
+    }
 
-            std::array<uint8_t, 3> new_bytes = {data[0], data[1], data[2]};
-                            
-            if(data[3] == 0){
-                online_mean_ch0.update(new_bytes);
-            }
+    // Start interrupt driven acquisition
+#ifndef COOPERATIVE_SCHEDULING
+    m_drdy_thread.start(callback(&m_drdy_queue, &EventQueue::dispatch_forever));
+#endif
+    m_acquisition_running = true;
+    m_bus.attach_drdy(callback(this, &AD7124::drdy_isr));
+    m_bus.enable_drdy_irq();
+}
+
+bool AD7124::process_block(void){
+    std::size_t batch_count = m_conversions.pop(m_batch, ACQUISITION_BLOCK_SIZE);
+    if (batch_count == 0){
+        return false;
+    }
+
+    // A batch yields at most ACQUISITION_BLOCK_SIZE / 2 + 1 values for the smallest ratio of 2.
+    int32_t decimated[ACQUISITION_BLOCK_SIZE / 2 + 1];
 
-            if(data[3] == 1){
-                online_mean_ch1.update(new_bytes);
+    if (m_window_settings_changed.exchange(false)){
+        m_window_mutex.lock();
+        for (int channel = 0; channel < ADC_CHANNELS; channel++){
+            if (m_byte_inputs[channel].length() != m_window_settings[channel].length){
+                m_byte_inputs[channel].set_length(m_window_settings[channel].length);
+                m_new_values[channel] = 0;
             }
-            thread_sleep_for(1); // to avoid CPU exhaustion
+            m_hops[channel] = m_window_settings[channel].hop;
         }
+        m_window_mutex.unlock();
+    }
 
-        auto mean_channel_0 = online_mean_ch0.get_mean();
+    if (m_conversions.get_overflow_count() != m_reported_overflows){
+        m_reported_overflows = m_conversions.get_overflow_count();
+        WARN("Conversion ring overflow, %lu conversions dropped", static_cast<unsigned long>(m_reported_overflows));
+    }
 
-        if(byte_inputs_channel_0.size() < vector_size){
-            byte_inputs_channel_0.push_back(mean_channel_0);
-        }
-        else{
-            byte_inputs_channel_0.erase(byte_inputs_channel_0.begin());
-            byte_inputs_channel_0.push_back(mean_channel_0);
-            circular_buffer_triggered_0 = true; // Circular buffer was used
+    // Dropped conversions show up as long gaps in the timestamps
+    m_statistics_mutex.lock();
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        m_statistics[channel].set_expected_gap(m_expected_gap_us);
+    }
+    for (std::size_t i = 0; i < batch_count; i++){
+        m_statistics[m_batch[i].channel].update(m_batch[i].timestamp);
+    }
+    m_statistics_mutex.unlock();
+
+    std::size_t filtered_count[ADC_CHANNELS] = {0};
+    for (std::size_t i = 0; i < batch_count; i++){
+        const int channel = m_batch[i].channel;
+        m_filtered[channel][filtered_count[channel]++] = m_medians[channel].update(m_batch[i].code);
+    }
+
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        std::size_t decimated_count = m_decimators[channel].process(m_filtered[channel], filtered_count[channel], decimated);
+        for (std::size_t i = 0; i < decimated_count; i++){
+            m_byte_inputs[channel].push(signed_code_to_bytes(decimated[i]));
+            if (m_new_values[channel] < UINT16_MAX){
+                m_new_values[channel]++;
+            }
         }
+    }
+
+    // A full window is due every hop values. While another full window is a single
+    // value short of its hop, sending waits for it, so channels whose values arrive
+    // in consecutive blocks share a mail. It waits one block at most, a channel that
+    // stopped yielding values must not hold back the others.
+    bool any_due = false;
+    bool any_almost_due = false;
+    uint16_t due_values[ADC_CHANNELS];
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        const bool full = m_byte_inputs[channel].full();
+        const bool due = full && m_new_values[channel] >= m_hops[channel];
+        due_values[channel] = due ? m_new_values[channel] : 0;
+        any_due = any_due || due;
+        any_almost_due = any_almost_due || (full && m_new_values[channel] + 1 == m_hops[channel]);
+    }
 
-        auto mean_channel_1 = online_mean_ch1.get_mean();
+    if (any_due && any_almost_due && !m_held_back){
+        m_held_back = true;
+    } else if (any_due){
+        m_held_back = false;
+        send_data_to_main_thread(m_byte_inputs, due_values);
 
-        if(byte_inputs_channel_1.size() < vector_size){
-            byte_inputs_channel_1.push_back(mean_channel_1);
+        for (int channel = 0; channel < ADC_CHANNELS; channel++){
+            if (due_values[channel] > 0){
+                m_new_values[channel] = 0;
+            }
         }
-        else{
-            byte_inputs_channel_1.erase(byte_inputs_channel_1.begin());
-            byte_inputs_channel_1.push_back(mean_channel_1);
-            circular_buffer_triggered_1 = true; // Circular buffer was used
+    }
+    return true;
+}
+
+#ifdef COOPERATIVE_SCHEDULING
+AD7124* AD7124::s_converters[ADC_DEVICES] = {};
+
+void AD7124::schedule_block(void){
+    if (m_parked){
+        return; // resume_parked() posts the block once the reading queue has a slot
+    }
+    if (!m_block_posted.exchange(true) && !EventLoop::getInstance().post(callback(this, &AD7124::run_block))){
+        m_block_posted = false; // Loop full, the next conversion tries again
+    }
+}
+
+/**
+ * One block per handler keeps the others waiting at most one block. A full Block
+ * edge would stall the whole loop in put(), so the converter is parked with its
+ * conversions in the ring until inference has taken a window, as the acquisition
+ * thread would sleep in put().
+ */
+void AD7124::run_block(void){
+    m_block_posted = false;
+    if (ReadingQueue::getInstance().queue.would_block()){
+        m_parked = true;
+        return;
+    }
+    process_block();
+    if (m_conversions.size() >= ACQUISITION_BLOCK_SIZE){
+        schedule_block();
+    }
+}
+
+/**
+ * Every parked converter gets its block posted. If several wait for one slot, the
+ * first block takes it and the others park again.
+ */
+void AD7124::resume_parked(void){
+    for (AD7124* converter : s_converters){
+        if (converter != nullptr && converter->m_parked.exchange(false)){
+            converter->schedule_block();
         }
-           
-        // **Send only when both buffers have replaced an old value**
-        if(circular_buffer_triggered_0 && circular_buffer_triggered_1){
-            send_data_to_main_thread(byte_inputs_channel_0, byte_inputs_channel_1);
-
-            // Reset flags after sending
-            circular_buffer_triggered_0 = false;
-            circular_buffer_triggered_1 = false;
+    }
+}
+#endif
+
+bool AD7124::set_window(int channel, unsigned int length, unsigned int hop){
+    if (channel < 0 || channel >= ADC_CHANNELS || length < 1 || length > VECTOR_SIZE || hop < 1 || hop > UINT16_MAX){
+        return false;
+    }
+    m_window_mutex.lock();
+    m_window_settings[channel] = {static_cast<uint16_t>(length), static_cast<uint16_t>(hop)};
+    m_window_mutex.unlock();
+    m_window_settings_changed = true;
+    return true;
+}
+
+/**
+ * @brief Copies the timing statistics of all channels. Safe to call from any thread.
+ */
+void AD7124::get_acquisition_statistics(AcquisitionStats::Statistics (&statistics)[ADC_CHANNELS], bool new_interval){
+    m_statistics_mutex.lock();
+    for (int channel = 0; channel < ADC_CHANNELS; channel++){
+        statistics[channel] = m_statistics[channel].get();
+        if (new_interval){
+            m_statistics[channel].reset_interval();
         }
     }
-}
\ No newline at end of file
+    m_statistics_mutex.unlock();
+}
@@ -0,0 +1,282 @@
+#include "adc/AD7124BusArbiter.h"
+
+AD7124BusArbiter::AD7124BusArbiter(AD7124Bus* const (&devices)[ADC_DEVICES]):
+    m_lines(nullptr), m_owner(NONE), m_selected(NONE), m_listening(NONE),
+    m_waiting_head(0), m_waiting_count(0), m_sequence(0){
+
+    init(devices);
+}
+
+AD7124BusArbiter::AD7124BusArbiter(int spi_frequency, const PinName* cs):
+    m_lines(new MbedAD7124Bus::Lines(spi_frequency)), m_owner(NONE), m_selected(NONE), m_listening(NONE),
+    m_waiting_head(0), m_waiting_count(0), m_sequence(0){
+
+    AD7124Bus* devices[ADC_DEVICES];
+    for (int device = 0; device < ADC_DEVICES; device++){
+        devices[device] = new MbedAD7124Bus(*m_lines, cs[device]);
+    }
+    init(devices);
+}
+
+AD7124BusArbiter::~AD7124BusArbiter(void){
+    if (m_lines != nullptr){
+        for (AD7124Bus* device : m_devices){
+            delete device;
+        }
+        delete m_lines;
+    }
+}
+
+void AD7124BusArbiter::init(AD7124Bus* const (&devices)[ADC_DEVICES]){
+    for (int device = 0; device < ADC_DEVICES; device++){
+        m_devices[device] = devices[device];
+        m_ports[device].m_arbiter = this;
+        m_ports[device].m_device = device;
+        m_requests[device] = {nullptr, nullptr, 0, false};
+        m_waiting[device] = NONE;
+        m_armed[device] = false;
+        m_async[device] = true;
+        m_serviced[device] = 0;
+
+        // DRDY shares its pin with MISO, so nothing is listened to until a driver arms it.
+        m_devices[device]->disable_drdy_irq();
+        m_devices[device]->set_cs(1);
+    }
+}
+
+AD7124Bus& AD7124BusArbiter::port(int device){
+    MBED_ASSERT(device >= 0 && device < ADC_DEVICES);
+    return m_ports[device];
+}
+
+void AD7124BusArbiter::select(int device){
+    if (m_selected == device){
+        return;
+    }
+    if (m_selected != NONE){
+        m_devices[m_selected]->set_cs(1);
+    }
+    m_devices[device]->set_cs(0);
+    m_selected = device;
+}
+
+void AD7124BusArbiter::stop_listening(void){
+    if (m_listening != NONE){
+        m_devices[m_listening]->disable_drdy_irq();
+        m_listening = NONE;
+    }
+}
+
+/**
+ * Devices at the same data rate become ready in turn, so selecting the one read
+ * longest ago follows their DRDY order. If its conversion is already waiting, the
+ * driver is notified as if the edge had just occurred.
+ */
+void AD7124BusArbiter::listen(void){
+    int next = NONE;
+    for (int device = 0; device < ADC_DEVICES; device++){
+        if (m_armed[device] && (next == NONE || static_cast<int32_t>(m_serviced[device] - m_serviced[next]) < 0)){
+            next = device;
+        }
+    }
+    if (next == NONE){
+        return;
+    }
+
+    select(next);
+    m_listening = next;
+    if (m_devices[next]->read_drdy() == 0){
+        drdy_edge();
+        return;
+    }
+    m_devices[next]->enable_drdy_irq();
+}
+
+void AD7124BusArbiter::drdy_edge(void){
+    CriticalSectionLock lock;
+    const int device = m_listening;
+    if (device == NONE){
+        return;
+    }
+    stop_listening();
+    if (m_drdy_handlers[device]){
+        m_drdy_handlers[device]();
+    }
+}
+
+void AD7124BusArbiter::acquire(int device){
+    {
+        CriticalSectionLock lock;
+        if (m_owner == NONE){
+            m_owner = device;
+            stop_listening();
+            select(device);
+            return;
+        }
+        MBED_ASSERT(m_waiting_count < ADC_DEVICES);
+        m_requests[device].async = false;
+        m_waiting[(m_waiting_head + m_waiting_count) % ADC_DEVICES] = device;
+        m_waiting_count++;
+    }
+    // release() selects the device before granting the bus
+    m_granted[device].acquire();
+}
+
+int AD7124BusArbiter::submit(int device, const char* tx, char* rx, int length, const Callback<void(int)>& done){
+    if (!m_async[device]){
+        return -1;
+    }
+    {
+        CriticalSectionLock lock;
+        m_requests[device] = {tx, rx, length, true};
+        m_transfer_done[device] = done;
+        if (m_owner != NONE){
+            MBED_ASSERT(m_waiting_count < ADC_DEVICES);
+            m_waiting[(m_waiting_head + m_waiting_count) % ADC_DEVICES] = device;
+            m_waiting_count++;
+            return 0;
+        }
+        m_owner = device;
+        stop_listening();
+        select(device);
+    }
+    if (!start(device)){
+        release(device);
+        return -1;
+    }
+    return 0;
+}
+
+bool AD7124BusArbiter::start(int device){
+    const Request& request = m_requests[device];
+    if (m_devices[device]->transfer_async(request.tx, request.rx, request.length,
+                                          callback(&m_ports[device], &Port::transfer_complete)) != 0){
+        m_async[device] = false;
+        return false;
+    }
+    return true;
+}
+
+void AD7124BusArbiter::release(int device){
+    CriticalSectionLock lock;
+    MBED_ASSERT(m_owner == device);
+    m_serviced[device] = ++m_sequence;
+
+    if (m_waiting_count > 0){
+        const int next = m_waiting[m_waiting_head];
+        m_waiting_head = (m_waiting_head + 1) % ADC_DEVICES;
+        m_waiting_count--;
+        m_owner = next;
+        select(next);
+        if (!m_requests[next].async){
+            m_granted[next].release();
+        } else if (!start(next)){
+            // Only the first asynchronous request of a device can be refused, it fails
+            const Callback<void(int)> done = m_transfer_done[next];
+            release(next);
+            done(AD7124Bus::TRANSFER_ERROR);
+        }
+        return;
+    }
+
+    m_owner = NONE;
+    listen();
+}
+
+/**
+ * The level can only be observed while the device is selected. If another device
+ * owns the bus, the conversion counts as not ready; the arbiter reads the level
+ * again when it listens to the device.
+ */
+int AD7124BusArbiter::read_drdy(int device){
+    CriticalSectionLock lock;
+    if (m_owner == device || (m_owner == NONE && m_selected == device)){
+        return m_devices[device]->read_drdy();
+    }
+    if (m_owner != NONE){
+        return 1;
+    }
+
+    stop_listening();
+    select(device);
+    const int level = m_devices[device]->read_drdy();
+    listen();
+    return level;
+}
+
+void AD7124BusArbiter::enable_drdy_irq(int device){
+    CriticalSectionLock lock;
+    m_armed[device] = true;
+    if (m_owner != NONE){
+        return;
+    }
+    if (m_listening == device){
+        m_devices[device]->enable_drdy_irq();
+    } else if (m_listening == NONE){
+        listen();
+    }
+}
+
+void AD7124BusArbiter::disable_drdy_irq(int device){
+    CriticalSectionLock lock;
+    m_armed[device] = false;
+    if (m_listening == device){
+        stop_listening();
+    }
+}
+
+int AD7124BusArbiter::Port::write(int value){
+    m_arbiter->acquire(m_device);
+    const int received = m_arbiter->m_devices[m_device]->write(value);
+    m_arbiter->release(m_device);
+    return received;
+}
+
+void AD7124BusArbiter::Port::transfer(const char* tx, char* rx, int length){
+    m_arbiter->acquire(m_device);
+    m_arbiter->m_devices[m_device]->transfer(tx, rx, length);
+    m_arbiter->release(m_device);
+}
+
+int AD7124BusArbiter::Port::transfer_async(const char* tx, char* rx, int length, const Callback<void(int)>& done){
+    return m_arbiter->submit(m_device, tx, rx, length, done);
+}
+
+/**
+ * The next request queued starts before the callback runs, so the bus does not
+ * idle while the driver handles its data.
+ */
+void AD7124BusArbiter::Port::transfer_complete(int event){
+    const Callback<void(int)> done = m_arbiter->m_transfer_done[m_device];
+    m_arbiter->release(m_device);
+    done(event);
+}
+
+int AD7124BusArbiter::Port::read_drdy(void){
+    return m_arbiter->read_drdy(m_device);
+}
+
+void AD7124BusArbiter::Port::attach_drdy(const Callback<void()>& handler){
+    m_arbiter->m_drdy_handlers[m_device] = handler;
+    m_arbiter->m_devices[m_device]->attach_drdy(callback(m_arbiter, &AD7124BusArbiter::drdy_edge));
+}
+
+void AD7124BusArbiter::Port::enable_drdy_irq(void){
+    m_arbiter->enable_drdy_irq(m_device);
+}
+
+void AD7124BusArbiter::Port::disable_drdy_irq(void){
+    m_arbiter->disable_drdy_irq(m_device);
+}
+
+void AD7124BusArbiter::Port::set_cs(int level){
+    (void)level; // Selected by the arbiter for every transaction
+}
+
+void AD7124BusArbiter::Port::set_sync(int level){
+    m_arbiter->m_devices[m_device]->set_sync(level);
+}
+
+uint32_t AD7124BusArbiter::Port::get_time_us(void){
+    return m_arbiter->m_devices[m_device]->get_time_us();
+}
@@ -0,0 +1,59 @@
+#include "adc/AcquisitionStats.h"
+
+AcquisitionStats::AcquisitionStats(void):
+    m_has_timestamp(false), m_last_timestamp(0), m_expected_gap_us(0),
+    m_total_count(0), m_total_missed(0){
+    reset_interval();
+}
+
+void AcquisitionStats::set_expected_gap(uint32_t expected_gap_us){
+    m_expected_gap_us = expected_gap_us;
+}
+
+void AcquisitionStats::update(uint32_t timestamp){
+    m_count++;
+    m_total_count++;
+
+    if (m_has_timestamp){
+        const uint32_t gap = timestamp - m_last_timestamp;
+        m_gap_count++;
+        m_gap_sum_us += gap;
+        if (gap < m_min_gap_us){
+            m_min_gap_us = gap;
+        }
+        if (gap > m_max_gap_us){
+            m_max_gap_us = gap;
+        }
+
+        // Jitter stays well below half an interval, longer gaps contain lost conversions
+        if (m_expected_gap_us > 0 && gap > m_expected_gap_us + m_expected_gap_us / 2){
+            const uint32_t lost = (gap + m_expected_gap_us / 2) / m_expected_gap_us - 1;
+            m_missed += lost;
+            m_total_missed += lost;
+        }
+    }
+    m_last_timestamp = timestamp;
+    m_has_timestamp = true;
+}
+
+AcquisitionStats::Statistics AcquisitionStats::get(void) const{
+    Statistics statistics;
+    statistics.count = m_count;
+    statistics.min_gap_us = (m_gap_count > 0) ? m_min_gap_us : 0;
+    statistics.max_gap_us = m_max_gap_us;
+    statistics.mean_gap_us = (m_gap_count > 0) ? static_cast<float>(m_gap_sum_us) / m_gap_count : 0.0f;
+    statistics.missed = m_missed;
+    statistics.expected_gap_us = m_expected_gap_us;
+    statistics.total_count = m_total_count;
+    statistics.total_missed = m_total_missed;
+    return statistics;
+}
+
+void AcquisitionStats::reset_interval(void){
+    m_count = 0;
+    m_gap_count = 0;
+    m_min_gap_us = UINT32_MAX;
+    m_max_gap_us = 0;
+    m_gap_sum_us = 0;
+    m_missed = 0;
+}
@@ -0,0 +1,75 @@
+#include "adc/CalibrationStore.h"
+#include <cstring>
+
+// Header of the stored record: magic number, format version and record size
+#define CALIBRATION_MAGIC 0x41443731 // "AD71"
+#define CALIBRATION_VERSION 1
+#define CALIBRATION_HEADER_SIZE 8
+
+CalibrationStore::CalibrationStore(BlockDevice& device): m_device(device){
+}
+
+/**
+ * FNV-1a over the header and the record. Erased flash (all ones) never matches.
+ */
+uint32_t CalibrationStore::checksum(const uint8_t* data, std::size_t size){
+    uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; i++){
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool CalibrationStore::load(Record& record){
+    if (m_device.init() != 0){
+        return false;
+    }
+    bool valid = BUFFER_SIZE % m_device.get_read_size() == 0 && m_device.size() >= BUFFER_SIZE &&
+                 m_device.read(m_buffer, 0, BUFFER_SIZE) == 0;
+    m_device.deinit();
+
+    const std::size_t payload = CALIBRATION_HEADER_SIZE + sizeof(Record);
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    uint16_t size = 0;
+    uint32_t stored_checksum = 0;
+    std::memcpy(&magic, m_buffer, sizeof(magic));
+    std::memcpy(&version, m_buffer + 4, sizeof(version));
+    std::memcpy(&size, m_buffer + 6, sizeof(size));
+    std::memcpy(&stored_checksum, m_buffer + payload, sizeof(stored_checksum));
+
+    valid = valid && magic == CALIBRATION_MAGIC && version == CALIBRATION_VERSION && size == sizeof(Record) &&
+            stored_checksum == checksum(m_buffer, payload);
+    if (valid){
+        std::memcpy(&record, m_buffer + CALIBRATION_HEADER_SIZE, sizeof(Record));
+        valid = record.setups <= SETUPS;
+    }
+    return valid;
+}
+
+bool CalibrationStore::save(const Record& record){
+    static_assert(CALIBRATION_HEADER_SIZE + sizeof(Record) + sizeof(uint32_t) <= BUFFER_SIZE,
+                  "The calibration record does not fit into the buffer");
+
+    const std::size_t payload = CALIBRATION_HEADER_SIZE + sizeof(Record);
+    const uint32_t magic = CALIBRATION_MAGIC;
+    const uint16_t version = CALIBRATION_VERSION;
+    const uint16_t size = sizeof(Record);
+
+    std::memset(m_buffer, 0xFF, BUFFER_SIZE);
+    std::memcpy(m_buffer, &magic, sizeof(magic));
+    std::memcpy(m_buffer + 4, &version, sizeof(version));
+    std::memcpy(m_buffer + 6, &size, sizeof(size));
+    std::memcpy(m_buffer + CALIBRATION_HEADER_SIZE, &record, sizeof(Record));
+    const uint32_t record_checksum = checksum(m_buffer, payload);
+    std::memcpy(m_buffer + payload, &record_checksum, sizeof(record_checksum));
+
+    if (m_device.init() != 0){
+        return false;
+    }
+    bool saved = BUFFER_SIZE % m_device.get_program_size() == 0 && m_device.size() >= BUFFER_SIZE &&
+                 m_device.erase(0, m_device.get_erase_size(0)) == 0 &&
+                 m_device.program(m_buffer, 0, BUFFER_SIZE) == 0;
+    m_device.deinit();
+    return saved;
+}
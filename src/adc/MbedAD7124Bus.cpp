@@ -0,0 +1,78 @@
+#include "adc/MbedAD7124Bus.h"
+
+MbedAD7124Bus::Lines::Lines(int spi_frequency, PinName mosi, PinName miso, PinName sclk, PinName sync):
+    m_spi(mosi, miso, sclk), m_drdy(miso), m_sync(sync){
+
+    // DRDY shares its pin with MISO, so the interrupt stays masked until acquisition starts.
+    m_drdy.disable_irq();
+
+    m_spi.format(8, 3);
+    m_spi.frequency(spi_frequency);
+#if DEVICE_SPI_ASYNCH
+    m_spi.set_dma_usage(DMA_USAGE_ALWAYS); // Conversions are clocked out by DMA
+#endif
+
+    m_timestamp_timer.start();
+}
+
+void MbedAD7124Bus::Lines::transfer_complete(int event){
+#if DEVICE_SPI_ASYNCH
+    m_transfer_done((event & SPI_EVENT_ERROR) ? TRANSFER_ERROR : 0);
+#else
+    (void)event;
+#endif
+}
+
+MbedAD7124Bus::MbedAD7124Bus(Lines& lines, PinName cs):
+    m_lines(lines), m_cs(cs, 1){
+}
+
+int MbedAD7124Bus::write(int value){
+    return m_lines.m_spi.write(value);
+}
+
+void MbedAD7124Bus::transfer(const char* tx, char* rx, int length){
+    m_lines.m_spi.write(tx, length, rx, length);
+}
+
+int MbedAD7124Bus::transfer_async(const char* tx, char* rx, int length, const Callback<void(int)>& done){
+#if DEVICE_SPI_ASYNCH
+    m_lines.m_transfer_done = done;
+    return m_lines.m_spi.transfer(tx, length, rx, length, callback(&m_lines, &Lines::transfer_complete),
+                                  SPI_EVENT_COMPLETE | SPI_EVENT_ERROR);
+#else
+    (void)tx;
+    (void)rx;
+    (void)length;
+    (void)done;
+    return -1;
+#endif
+}
+
+int MbedAD7124Bus::read_drdy(void){
+    return m_lines.m_drdy.read();
+}
+
+void MbedAD7124Bus::attach_drdy(const Callback<void()>& handler){
+    m_lines.m_drdy.fall(handler);
+}
+
+void MbedAD7124Bus::enable_drdy_irq(void){
+    m_lines.m_drdy.enable_irq();
+}
+
+void MbedAD7124Bus::disable_drdy_irq(void){
+    m_lines.m_drdy.disable_irq();
+}
+
+void MbedAD7124Bus::set_cs(int level){
+    m_cs = level;
+}
+
+void MbedAD7124Bus::set_sync(int level){
+    m_lines.m_sync = level;
+}
+
+uint32_t MbedAD7124Bus::get_time_us(void){
+    return static_cast<uint32_t>(m_lines.m_timestamp_timer.elapsed_time().count());
+}
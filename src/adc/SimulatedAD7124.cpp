@@ -0,0 +1,506 @@
+#include "adc/SimulatedAD7124.h"
+#include "adc/AD7124-defs.h"
+#include <cmath>
+
+// Nominal gain register value, the model scales conversions by GAIN / GAIN_NOMINAL
+#define GAIN_NOMINAL 0x555555
+
+// Channel, setup and filter fields of the model
+#define CHANNEL_COUNT 16
+#define CH_ENABLED(reg) (((reg) >> 15) & 0x1)
+#define CH_SETUP(reg) (((reg) >> 12) & 0x7)
+#define ADC_MODE(reg) (((reg) >> 2) & 0xF)
+#define ADC_POWER_MODE(reg) (((reg) >> 6) & 0x3)
+#define CH_AINP(reg) (((reg) >> 5) & 0x1F)
+
+// Positive input selecting the internal temperature sensor, and the die temperature of the model
+#define TEMPERATURE_SENSOR_INPUT 16
+#define DIE_TEMPERATURE 25.0
+
+// Worker thread running the asynchronous transfers
+#define WORKER_QUEUE_EVENTS 4
+#define WORKER_THREAD_STACK_SIZE 1024
+
+namespace {
+
+const int32_t CODE_MAX = 8388607;
+const int32_t CODE_MIN = -8388608;
+
+int32_t clamp_code(int64_t value) {
+    return static_cast<int32_t>(value > CODE_MAX ? CODE_MAX : (value < CODE_MIN ? CODE_MIN : value));
+}
+
+} // namespace
+
+SimulatedAD7124::SimulatedAD7124(unsigned int speedup):
+    m_speedup(speedup), m_irq_enabled(false),
+    m_worker_queue(WORKER_QUEUE_EVENTS * EVENTS_EVENT_SIZE),
+    m_worker(osPriorityHigh, WORKER_THREAD_STACK_SIZE, nullptr, "ad7124_sim"),
+    m_async_tx(nullptr), m_async_rx(nullptr), m_async_length(0),
+    m_trace(&SimulatedAD7124::synthetic_trace),
+    m_recorded_codes(nullptr), m_recorded_count(0), m_recorded_channels(0){
+
+    for (int channel = 0; channel < CHANNEL_COUNT; channel++){
+        m_recorded_index[channel] = 0;
+    }
+    m_time_us = 0;
+    m_conversion_count = 0;
+    m_missed_count = 0;
+    reset_registers();
+    m_worker.start(callback(&m_worker_queue, &EventQueue::dispatch_forever));
+}
+
+/**
+ * @brief Power-on state: all registers at their reset values, no conversion running.
+ */
+void SimulatedAD7124::reset_registers(void){
+    m_timeout.detach();
+    for (int address = 0; address < REGISTER_COUNT; address++){
+        m_registers[address] = 0;
+    }
+    m_registers[AD7124_ID_REG] = 0x14;           // AD7124-8
+    m_registers[AD7124_ERREN_REG] = 0x000040;
+    m_registers[AD7124_CH0_MAP_REG] = 0x8001;    // Channel 0 enabled on AIN0/AIN1
+    for (int channel = 1; channel < CHANNEL_COUNT; channel++){
+        m_registers[AD7124_CH0_MAP_REG + channel] = 0x0001;
+    }
+    for (int setup = 0; setup < 8; setup++){
+        m_registers[AD7124_CFG0_REG + setup] = 0x0860;
+        m_registers[AD7124_FILT0_REG + setup] = 0x060180;
+        m_registers[AD7124_OFFS0_REG + setup] = 0x800000;
+        m_registers[AD7124_GAIN0_REG + setup] = GAIN_NOMINAL;
+    }
+
+    m_spi_state = SpiState::Command;
+    m_address = 0;
+    m_bytes_left = 0;
+    m_shift = 0;
+    m_ones = 0;
+    m_converting = false;
+    m_calibrating = false;
+    m_ready = false;
+    m_channel = 0;
+    m_data_channel = 0;
+    m_data = 0;
+    m_first_conversion = true;
+}
+
+void SimulatedAD7124::set_trace(const trace_t& trace){
+    CriticalSectionLock lock;
+    m_trace = trace;
+}
+
+void SimulatedAD7124::set_recorded_trace(const int32_t* codes, std::size_t count, int channels){
+    CriticalSectionLock lock;
+    m_recorded_codes = codes;
+    m_recorded_count = count;
+    m_recorded_channels = channels;
+    for (int channel = 0; channel < CHANNEL_COUNT; channel++){
+        m_recorded_index[channel] = 0;
+    }
+    m_trace = callback(this, &SimulatedAD7124::recorded_sample);
+}
+
+int32_t SimulatedAD7124::recorded_sample(int channel, uint64_t time_us){
+    (void)time_us;
+    if (m_recorded_codes == nullptr || m_recorded_count == 0 || channel >= m_recorded_channels){
+        return 0;
+    }
+    std::size_t position = (m_recorded_index[channel]++ * m_recorded_channels + channel) % m_recorded_count;
+    return m_recorded_codes[position];
+}
+
+/**
+ * A sine with a period of one hour and a channel dependent phase, plus
+ * uniform noise of +-16 codes and a spike in about one of 1000 conversions.
+ * The noise is a hash of time and channel, so every run is reproducible.
+ */
+int32_t SimulatedAD7124::synthetic_trace(int channel, uint64_t time_us){
+    const double seconds = static_cast<double>(time_us) * 1e-6;
+    const double signal = 2000.0 * std::sin(2.0 * M_PI * seconds / 3600.0 + 0.7 * channel);
+
+    uint32_t hash = static_cast<uint32_t>(time_us / 1000) * 2654435761u ^ static_cast<uint32_t>(channel) * 40503u;
+    hash ^= hash >> 13;
+    hash *= 0x5bd1e995u;
+    hash ^= hash >> 15;
+
+    int32_t code = static_cast<int32_t>(signal) + static_cast<int32_t>(hash & 0x1F) - 16;
+    if (hash % 1000 == 0){
+        code += 50000;
+    }
+    return code;
+}
+
+uint64_t SimulatedAD7124::get_simulated_time_us(void) const{
+    return m_time_us;
+}
+
+uint32_t SimulatedAD7124::get_conversion_count(void) const{
+    return m_conversion_count;
+}
+
+uint32_t SimulatedAD7124::get_missed_count(void) const{
+    return m_missed_count;
+}
+
+int SimulatedAD7124::register_size(uint8_t address) const{
+    if (address == AD7124_STATUS_REG || address == AD7124_ID_REG || address == 0x08){
+        return 1;
+    }
+    if (address == AD7124_DATA_REG){
+        return (m_registers[AD7124_ADC_CTRL_REG] & AD7124_ADC_CTRL_REG_DATA_STATUS) ? 4 : 3;
+    }
+    if (address == AD7124_ADC_CTRL_REG || address == AD7124_IO_CTRL2_REG ||
+        (address >= AD7124_CH0_MAP_REG && address < AD7124_FILT0_REG)){
+        return 2;
+    }
+    return 3;
+}
+
+uint32_t SimulatedAD7124::read_register_value(uint8_t address){
+    const uint32_t status = (m_ready ? 0 : AD7124_STATUS_REG_RDY) | AD7124_STATUS_REG_CH_ACTIVE(m_data_channel);
+    if (address == AD7124_STATUS_REG){
+        return status;
+    }
+    if (address == AD7124_DATA_REG){
+        if (m_registers[AD7124_ADC_CTRL_REG] & AD7124_ADC_CTRL_REG_DATA_STATUS){
+            return (m_data << 8) | status;
+        }
+        return m_data;
+    }
+    return m_registers[address];
+}
+
+void SimulatedAD7124::write_register_value(uint8_t address, uint32_t value){
+    if (address == AD7124_STATUS_REG || address == AD7124_DATA_REG || address == AD7124_ID_REG ||
+        address == AD7124_ERR_REG || address == 0x08){
+        return; // Read only
+    }
+    m_registers[address] = value & ((1UL << (8 * register_size(address))) - 1);
+
+    // Writing the control register restarts the converter in the selected mode
+    if (address == AD7124_ADC_CTRL_REG){
+        start_mode();
+    }
+}
+
+int SimulatedAD7124::next_enabled_channel(int channel) const{
+    for (int i = 1; i <= CHANNEL_COUNT; i++){
+        int candidate = (channel + i + CHANNEL_COUNT) % CHANNEL_COUNT;
+        if (CH_ENABLED(m_registers[AD7124_CH0_MAP_REG + candidate])){
+            return candidate;
+        }
+    }
+    return -1;
+}
+
+void SimulatedAD7124::start_mode(void){
+    m_timeout.detach();
+    m_converting = false;
+    m_calibrating = false;
+    m_ready = false;
+
+    const uint32_t mode = ADC_MODE(m_registers[AD7124_ADC_CTRL_REG]);
+    const bool converting = mode == 0 || mode == 1;          // Continuous or single conversion
+    const bool calibrating = mode >= 5 && mode <= 8;         // Internal or system calibration
+    if (!converting && !calibrating){
+        return; // Standby, power down or idle
+    }
+
+    m_channel = next_enabled_channel(-1);
+    if (m_channel < 0){
+        return;
+    }
+    m_converting = true;
+    m_calibrating = calibrating;
+    m_first_conversion = true;
+    schedule_conversion();
+}
+
+/**
+ * @brief Time from the start of a conversion to its result, from the data sheet formulas.
+ *
+ * In a channel sequence, in single cycle mode and after a restart every result
+ * is fully settled. A single channel in continuous mode delivers at the output data rate.
+ */
+uint64_t SimulatedAD7124::conversion_time_us(int channel) const{
+    const uint32_t filter_register = m_registers[AD7124_FILT0_REG + CH_SETUP(m_registers[AD7124_CH0_MAP_REG + channel])];
+    const uint32_t filter = (filter_register >> 21) & 0x7;
+    const uint32_t post_filter = (filter_register >> 17) & 0x7;
+    const bool single_cycle = (filter_register & AD7124_FILT_REG_SINGLE_CYCLE) != 0;
+    const double fs = (filter_register & 0x7FF) ? static_cast<double>(filter_register & 0x7FF) : 1.0;
+
+    const uint32_t power_mode = ADC_POWER_MODE(m_registers[AD7124_ADC_CTRL_REG]);
+    const double f_clk = (power_mode == 0) ? 76800.0 : ((power_mode == 1) ? 153600.0 : 614400.0);
+    const double average = (power_mode == 0) ? 8.0 : 16.0;
+
+    const bool sequencing = next_enabled_channel(channel) != channel;
+    const bool settled = sequencing || single_cycle || m_first_conversion || m_calibrating;
+
+    double seconds = 0.0;
+    switch (filter){
+        case 2: // sinc3
+            seconds = 32.0 * fs / f_clk * (settled ? 3.0 : 1.0);
+            break;
+        case 4: // fast settling sinc4
+            seconds = 32.0 * fs * (4.0 + average - 1.0) / f_clk;
+            break;
+        case 5: // fast settling sinc3
+            seconds = 32.0 * fs * (3.0 + average - 1.0) / f_clk;
+            break;
+        case 7: // post filter
+            switch (post_filter){
+                case 2: seconds = settled ? 0.04154 : 1.0 / 27.27; break;
+                case 3: seconds = settled ? 0.04440 : 1.0 / 25.0; break;
+                case 5: seconds = settled ? 0.05220 : 1.0 / 20.0; break;
+                default: seconds = settled ? 0.06130 : 1.0 / 16.67; break;
+            }
+            break;
+        default: // sinc4
+            seconds = 32.0 * fs / f_clk * (settled ? 4.0 : 1.0);
+            break;
+    }
+    return static_cast<uint64_t>(seconds * 1e6 + 0.5);
+}
+
+void SimulatedAD7124::schedule_conversion(void){
+    if (!m_converting || m_speedup == 0){
+        return; // Without speedup the conversion completes when the driver waits for it
+    }
+    uint64_t delay = conversion_time_us(m_channel) / m_speedup;
+    m_timeout.attach(callback(this, &SimulatedAD7124::timeout_event),
+                     std::chrono::microseconds(delay > 0 ? delay : 1));
+}
+
+/**
+ * @brief Finishes the running conversion or calibration and starts the next one.
+ * @return True if DOUT/RDY fell.
+ */
+bool SimulatedAD7124::complete_conversion(void){
+    if (!m_converting){
+        return false;
+    }
+    m_time_us += conversion_time_us(m_channel);
+
+    const int setup = CH_SETUP(m_registers[AD7124_CH0_MAP_REG + m_channel]);
+    const uint32_t mode = ADC_MODE(m_registers[AD7124_ADC_CTRL_REG]);
+
+    if (m_calibrating){
+        if (mode == 5){         // Internal zero-scale: the model has no offset error
+            m_registers[AD7124_OFFS0_REG + setup] = 0x800000;
+        } else if (mode == 6){  // Internal full-scale: the model has no gain error
+            m_registers[AD7124_GAIN0_REG + setup] = GAIN_NOMINAL;
+        } else if (mode == 7){  // System zero-scale: the applied input becomes zero
+            m_registers[AD7124_OFFS0_REG + setup] = (0x800000 + m_trace(m_channel, m_time_us)) & 0xFFFFFF;
+        }
+        // The part returns to idle mode and signals the end of the calibration on DOUT/RDY
+        m_registers[AD7124_ADC_CTRL_REG] = (m_registers[AD7124_ADC_CTRL_REG] & ~AD7124_ADC_CTRL_REG_MODE(0xF)) |
+                                           AD7124_ADC_CTRL_REG_MODE(4);
+        m_converting = false;
+        m_calibrating = false;
+        m_ready = true;
+        m_data_channel = m_channel;
+        return true;
+    }
+
+    // Offset and gain calibration are applied like in the part
+    const int64_t offset = static_cast<int64_t>(m_registers[AD7124_OFFS0_REG + setup]) - 0x800000;
+    const int64_t gain = m_registers[AD7124_GAIN0_REG + setup];
+    // The temperature sensor gives 13584 codes per kelvin at gain 1, the trace feeds the analog inputs
+    const bool temperature = CH_AINP(m_registers[AD7124_CH0_MAP_REG + m_channel]) == TEMPERATURE_SENSOR_INPUT;
+    const int64_t input = temperature ? static_cast<int64_t>((DIE_TEMPERATURE + 272.5) * 13584.0) :
+                                        m_trace(m_channel, m_time_us);
+    const int32_t code = clamp_code((input - offset) * gain / GAIN_NOMINAL);
+
+    if (m_ready){
+        m_missed_count++;
+    }
+    const bool bipolar = (m_registers[AD7124_CFG0_REG + setup] & AD7124_CFG_REG_BIPOLAR) != 0;
+    m_data = bipolar ? static_cast<uint32_t>(code + 0x800000) : static_cast<uint32_t>(code < 0 ? 0 : 2 * code);
+    m_data &= 0xFFFFFF;
+    m_data_channel = m_channel;
+    m_ready = true;
+    m_conversion_count++;
+    m_first_conversion = false;
+
+    if (mode == 1){
+        m_converting = false; // Single conversion
+    } else {
+        m_channel = next_enabled_channel(m_channel);
+        schedule_conversion();
+    }
+    return true;
+}
+
+void SimulatedAD7124::timeout_event(void){
+    bool fell = false;
+    {
+        CriticalSectionLock lock;
+        fell = complete_conversion();
+    }
+    if (fell){
+        fire_drdy();
+    }
+}
+
+void SimulatedAD7124::fire_drdy(void){
+    if (m_irq_enabled && m_drdy_handler){
+        m_drdy_handler();
+    }
+}
+
+/**
+ * @brief One byte of the serial interface.
+ *
+ * Outside continuous read mode the first byte of a frame is written to the
+ * communications register and selects a register read or write. In continuous
+ * read mode a ready conversion is clocked out directly, unless the byte is the
+ * read data command, which leaves continuous read mode.
+ */
+int SimulatedAD7124::write(int value){
+    CriticalSectionLock lock;
+    value &= 0xFF;
+
+    // 64 consecutive ones reset the part
+    m_ones = (value == 0xFF) ? m_ones + 1 : 0;
+    if (m_ones >= 8){
+        reset_registers();
+        return 0xFF;
+    }
+
+    switch (m_spi_state){
+        case SpiState::Command: {
+            const bool continuous_read = (m_registers[AD7124_ADC_CTRL_REG] & AD7124_ADC_CTRL_REG_CONT_READ) != 0;
+            if (continuous_read){
+                if (!m_ready){
+                    return 0xFF; // DOUT/RDY high, nothing to clock out
+                }
+                m_address = AD7124_DATA_REG;
+                m_shift = read_register_value(AD7124_DATA_REG);
+                m_bytes_left = register_size(AD7124_DATA_REG);
+                m_spi_state = SpiState::Read;
+                if (value == (AD7124_COMM_REG_RD | AD7124_DATA_REG)){
+                    m_registers[AD7124_ADC_CTRL_REG] &= ~AD7124_ADC_CTRL_REG_CONT_READ;
+                    return 0xFF; // The data follows as a normal data register read
+                }
+                break; // The first data byte is clocked out with this byte
+            }
+
+            if (value & 0x80){
+                return 0xFF; // WEN must be low
+            }
+            m_address = AD7124_COMM_REG_RA(value);
+            if (m_address >= REGISTER_COUNT){
+                return 0xFF;
+            }
+            m_bytes_left = register_size(m_address);
+            if (value & AD7124_COMM_REG_RD){
+                m_shift = read_register_value(m_address);
+                m_spi_state = SpiState::Read;
+            } else {
+                m_shift = 0;
+                m_spi_state = SpiState::Write;
+            }
+            return 0xFF;
+        }
+
+        case SpiState::Write:
+            m_shift = (m_shift << 8) | static_cast<uint32_t>(value);
+            if (--m_bytes_left == 0){
+                m_spi_state = SpiState::Command;
+                write_register_value(m_address, m_shift);
+            }
+            return 0xFF;
+
+        case SpiState::Read:
+        default:
+            break;
+    }
+
+    // Shift out the next byte of a read, MSB first
+    m_bytes_left--;
+    const int output = (m_shift >> (8 * m_bytes_left)) & 0xFF;
+    if (m_bytes_left == 0){
+        m_spi_state = SpiState::Command;
+        if (m_address == AD7124_DATA_REG){
+            m_ready = false; // Reading the data register releases DOUT/RDY
+        }
+    }
+    return output;
+}
+
+void SimulatedAD7124::transfer(const char* tx, char* rx, int length){
+    for (int i = 0; i < length; i++){
+        rx[i] = static_cast<char>(write(static_cast<uint8_t>(tx[i])));
+    }
+}
+
+/**
+ * The caller runs one transaction at a time, so the request is kept in members
+ * and the event only carries the model.
+ */
+int SimulatedAD7124::transfer_async(const char* tx, char* rx, int length, const Callback<void(int)>& done){
+    m_async_tx = tx;
+    m_async_rx = rx;
+    m_async_length = length;
+    m_async_done = done;
+    return m_worker_queue.call(callback(this, &SimulatedAD7124::run_async_transfer)) == 0 ? -1 : 0;
+}
+
+void SimulatedAD7124::run_async_transfer(void){
+    transfer(m_async_tx, m_async_rx, m_async_length);
+    m_async_done(0);
+}
+
+int SimulatedAD7124::read_drdy(void){
+    CriticalSectionLock lock;
+    if (m_speedup == 0 && !m_ready){
+        complete_conversion();
+    }
+    return m_ready ? 0 : 1;
+}
+
+void SimulatedAD7124::attach_drdy(const Callback<void()>& handler){
+    m_drdy_handler = handler;
+}
+
+/**
+ * Without speedup the next conversion completes as soon as the driver waits for
+ * it, so unmasking the interrupt delivers its edge.
+ */
+void SimulatedAD7124::enable_drdy_irq(void){
+    m_irq_enabled = true;
+    bool fell = false;
+    {
+        CriticalSectionLock lock;
+        if (m_speedup == 0){
+            if (!m_ready){
+                complete_conversion();
+            }
+            fell = m_ready;
+        }
+    }
+    if (fell){
+        fire_drdy();
+    }
+}
+
+void SimulatedAD7124::disable_drdy_irq(void){
+    m_irq_enabled = false;
+}
+
+void SimulatedAD7124::set_cs(int level){
+    // Deasserting CS resets the serial interface
+    if (level){
+        CriticalSectionLock lock;
+        m_spi_state = SpiState::Command;
+    }
+}
+
+void SimulatedAD7124::set_sync(int level){
+    (void)level;
+}
+
+uint32_t SimulatedAD7124::get_time_us(void){
+    return static_cast<uint32_t>(m_time_us);
+}
@@ -0,0 +1,29 @@
+#include "interfaces/EventLoop.h"
+
+// Handlers pending at once: a conversion read and a block per converter, one inference job per
+// channel of the window being classified, one hand-off per slot of both queues and headroom
+#define EVENT_LOOP_EVENTS (2 * ADC_DEVICES + ADC_CHANNELS + READING_QUEUE_DEPTH + SENDING_QUEUE_DEPTH + 4)
+
+// Static method to access the single instance
+EventLoop& EventLoop::getInstance() {
+    static EventLoop instance;  // Guaranteed to be destroyed, initialized on first use
+    return instance;
+}
+
+// Private constructor to prevent direct instantiation
+EventLoop::EventLoop(void): m_queue(EVENT_LOOP_EVENTS * EVENTS_EVENT_SIZE) {
+    // Initialization code, if necessary
+}
+
+// Private destructor (optional)
+EventLoop::~EventLoop() {
+    // Cleanup code, if necessary
+}
+
+bool EventLoop::post(const Callback<void()>& handler) {
+    return m_queue.call(handler) != 0;
+}
+
+void EventLoop::dispatch(void) {
+    m_queue.dispatch_forever();
+}
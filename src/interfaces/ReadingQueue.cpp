@@ -8,8 +8,9 @@ ReadingQueue& ReadingQueue::getInstance() {
 }
 
 // Private constructor to prevent direct instantiation
-ReadingQueue::ReadingQueue(void) {
-    // Initialization code, if necessary
+ReadingQueue::ReadingQueue(void): queue("reading", READING_QUEUE_POLICY) {
+    queue.set_release(callback(&WindowPool::getInstance(), &WindowPool::release));
+    queue.set_coalesce(&WindowPool::coalesce);
 }
 
 // Private destructor (optional)
@@ -7,8 +7,9 @@ SendingQueue& SendingQueue::getInstance() {
 }
 
 // Private constructor to prevent direct instantiation
-SendingQueue::SendingQueue(void) {
-    // Initialization code, if necessary
+SendingQueue::SendingQueue(void): queue("sending", SENDING_QUEUE_POLICY) {
+    queue.set_release(callback(&WindowPool::getInstance(), &WindowPool::release));
+    queue.set_coalesce(&WindowPool::coalesce);
 }
 
 // Private destructor (optional)
@@ -0,0 +1,59 @@
+#include "interfaces/WindowPool.h"
+#include <algorithm>
+#include <new>
+
+// Static method to access the single instance
+WindowPool& WindowPool::getInstance() {
+    static WindowPool instance;  // Guaranteed to be destroyed, initialized on first use
+    return instance;
+}
+
+// Private constructor to prevent direct instantiation
+WindowPool::WindowPool(void) {
+    m_clock.start();
+}
+
+// Private destructor (optional)
+WindowPool::~WindowPool() {
+    // Cleanup code, if necessary
+}
+
+// The pool itself is the backpressure of the pipeline: acquisition sleeps here while every
+// buffer is queued or being processed.
+WindowPool::Buffer* WindowPool::alloc(void) {
+    Buffer* buffer = m_pool.try_alloc_for(rtos::Kernel::Clock::duration_u32::max());
+    if (buffer != nullptr) {
+        // Default initialisation leaves the windows untouched, only the count is set
+        new (buffer) Buffer;
+        buffer->references = 1;
+        buffer->timestamp_us = get_time_us();
+    }
+    return buffer;
+}
+
+void WindowPool::retain(Buffer* buffer) {
+    buffer->references.fetch_add(1);
+}
+
+void WindowPool::release(Buffer* buffer) {
+    if (buffer->references.fetch_sub(1) == 1) {
+        m_pool.free(buffer);
+    }
+}
+
+bool WindowPool::coalesce(Buffer* latest, Buffer* queued) {
+    if (latest->device != queued->device) {
+        return false;
+    }
+    for (int channel = 0; channel < ADC_CHANNELS; channel++) {
+        // The classification of a channel that was due in the queued window is lost,
+        // the newer window is classified in its place
+        const uint32_t new_values = static_cast<uint32_t>(latest->new_values[channel]) + queued->new_values[channel];
+        latest->new_values[channel] = static_cast<uint16_t>(std::min<uint32_t>(new_values, latest->lengths[channel]));
+    }
+    return true;
+}
+
+uint32_t WindowPool::get_time_us(void) {
+    return static_cast<uint32_t>(m_clock.elapsed_time().count());
+}
@@ -6,8 +6,13 @@ Change the values of the following variables in the file: mbed-os/connectivity/F
 */
 
 #include "mbed.h"
+#include "FlashIAPBlockDevice.h"
+#include "blockdevice/SlicingBlockDevice.h"
 
 // Standard Library Headers
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -15,14 +20,19 @@ Change the values of the following variables in the file: mbed-os/connectivity/F
 
 // Project-Specific Headers
 #include "adc/AD7124.h"
+#include "adc/AD7124BusArbiter.h"
+#include "adc/SimulatedAD7124.h"
+#include "adc/CalibrationStore.h"
+#include "interfaces/EventLoop.h"
 #include "interfaces/ReadingQueue.h"
 #include "interfaces/SendingQueue.h"
-#include "model_executor/ModelExecutor.h"
+#include "interfaces/WindowPool.h"
+#include "model_executor/InferenceService.h"
 #include "serial_mail_sender/SerialMailSender.h"
-#include "preprocessing/Normalization.h"
+#include "preprocessing/AdaptiveNormalizer.h"
+#include "preprocessing/Decimator.h"
+#include "preprocessing/LinearDetrend.h"
 #include "utils/mbed_stats_wrapper.h"
-#include "utils/reading_mutex.h"
-#include "utils/sending_mutex.h"
 #include "utils/constants.h"
 
 // Utility Headers
@@ -31,119 +41,374 @@ Change the values of the following variables in the file: mbed-os/connectivity/F
 
 // *** DEFINE GLOBAL CONSTANTS ***
 #define DOWNSAMPLING_RATE 600 // seconds 
+#define DECIMATION_PERIOD_TOLERANCE 0.01f // relative deviation of the value period before a warning
+
+// INFERENCE SCHEDULING
+#define WINDOW_LENGTH VECTOR_SIZE // values per window, the model input length
+#define WINDOW_HOP 1 // new values between two inferences of a channel, 10 classifies once a minute
+
+// STATISTICS
+// The serial console also carries the mails, so the statistics are reported rarely
+#define STATISTICS_WINDOWS 600 // windows of a converter between two reports, an hour at a hop of 1
+
+// SPIKE REJECTION
+#define MEDIAN_WINDOW 7 // raw conversions, values below 2 disable the filter
+#define SPIKE_THRESHOLD 0 // codes, 0 always replaces a conversion by the median
 
 // CONVERSION
 #define DATABITS 8388608
 #define VREF 2.5
-#define GAIN 4.0
+#define GAIN 4.0 // must match ADC_PGA_GAIN
+
+// NORMALIZATION
+// Bounds follow the min/max of the last 24 hours (24 blocks of 600 values at 6 s per value)
+#define NORMALIZATION_BLOCK_COUNT 24
+#define NORMALIZATION_BLOCK_LENGTH 600
+#define NORMALIZATION_MIN_SPAN 0.4 // mV, matches the former fixed bounds of -0.2 and 0.2 mV
 
 // ADC
 #define SPI_FREQUENCY 10000000 // 1MHz
+#define ADC_POWER_MODE AD7124::PowerMode::Low
+#define ADC_FILTER AD7124::FilterType::Sinc4
+#define ADC_FILTER_FS 6 // 400 SPS in low power mode, 50 settled conversions per second and channel
+#define ADC_PGA_GAIN AD7124::PgaGain::x4
+#define ADC_CALIBRATION_TEMPERATURE_DELTA 5.0f // degrees Celsius of die temperature change before recalibrating
+#define ADC_CALIBRATION_SLICE_SIZE 4096 // bytes of calibration flash per converter, one page of the WB55
+// Board-specific: the chip selects depend on the wiring of the node and are not documented for it yet,
+// check them against its schematic before connecting more than one converter
+#define ADC_CS_PINS {PA_4, PA_9, PC_6, PC_10} // CS of converter 0 to 3, SCLK (PA_5), MOSI (PA_7), MISO (PA_6) and SYNC (PA_1) are shared
+//#define ADC_SIMULATION // Replace the AD7124 by a trace-fed software model
+#define ADC_SIMULATION_SPEEDUP 0 // simulated time per real time, 0 converts as fast as the pipeline reads
+
+// SCHEDULING
+#ifdef COOPERATIVE_SCHEDULING
+#define SCHEDULING_MODE "cooperative" // label of the memory report
+#else
+#define SCHEDULING_MODE "threaded"
+#endif
 
-// Thread for reading data from ADC
-Thread reading_data_thread;
+static const PinName adc_cs_pins[] = ADC_CS_PINS;
+static_assert(ADC_DEVICES >= 1 && ADC_DEVICES <= sizeof(adc_cs_pins) / sizeof(adc_cs_pins[0]),
+	"Every converter needs a chip select");
 
+#ifndef COOPERATIVE_SCHEDULING
+// Threads for reading data from the ADCs, one per converter
+Thread reading_data_threads[ADC_DEVICES];
+#endif
+
+// Arbiter sharing the SPI bus between the converters, created by main()
+AD7124BusArbiter* adc_bus_arbiter;
+
+// Driver of every converter, set before it hands on its first window
+AD7124* adcs[ADC_DEVICES];
+
+#ifndef COOPERATIVE_SCHEDULING
 // Thread for sending data to data sink
 Thread sending_data_thread;
+#endif
+
+// Classification state, set up by main() before acquisition starts
+// One normaliser per channel of every converter keeps its bounds across windows
+// One detrending stage per channel of every converter, its running sums slide with the window
+// The state of channel c of converter d is at d * ADC_CHANNELS + c
+std::vector<AdaptiveNormalizer> normalizers;
+std::vector<LinearDetrend> detrends;
+
+// Model inputs and inference jobs are reused for every window
+InferenceService::input_t inputs_normalized[ADC_CHANNELS];
+InferenceService::Job jobs[ADC_CHANNELS];
 
-// Function called in thread "reading_data_thread"
-void get_input_model_values_from_adc(void){
-	AD7124& adc = AD7124::getInstance(SPI_FREQUENCY);
-	adc.read_voltage_from_both_channels(DOWNSAMPLING_RATE, VECTOR_SIZE); 
+// Last classification of every channel, attached again while its hop has not elapsed
+std::array<float, CLASSES> results[ADC_DEVICES * ADC_CHANNELS];
+
+// The detrending stages follow the window lengths
+std::size_t window_lengths[ADC_DEVICES * ADC_CHANNELS];
+
+// Function called in thread "reading_data_threads[device]", or once by main() with COOPERATIVE_SCHEDULING
+void get_input_model_values_from_adc(int device){
+	// The driver is never destroyed, it acquires forever
+	AD7124& adc = *new AD7124(adc_bus_arbiter->port(device), static_cast<uint8_t>(device));
+	adcs[device] = &adc;
+
+	AD7124::Configuration configuration = adc.get_configuration();
+	configuration.power_mode = ADC_POWER_MODE;
+	for (AD7124::SetupConfig& setup : configuration.setups){
+		setup.filter = ADC_FILTER;
+		setup.filter_select = ADC_FILTER_FS;
+		setup.gain = ADC_PGA_GAIN;
+	}
+	if (!adc.configure(configuration)){
+		ERROR("ADC configuration failed");
+	}
+
+	// Offset and gain coefficients persist in the flash behind the application, one slice
+	// per converter, and are reused while the die temperature stays close to the one they were taken at
+	static FlashIAPBlockDevice calibration_device;
+	SlicingBlockDevice calibration_slice(&calibration_device, device * ADC_CALIBRATION_SLICE_SIZE,
+		(device + 1) * ADC_CALIBRATION_SLICE_SIZE);
+	CalibrationStore calibration_store(calibration_slice);
+	if (!adc.calibrate(calibration_store, ADC_CALIBRATION_TEMPERATURE_DELTA)){
+		ERROR("ADC calibration failed");
+	}
+
+	// Conversions per channel that are decimated into one window value (6 s per value). The
+	// decimator takes even ratios only, so the period is checked against the configured one.
+	const float value_period = static_cast<float>(DOWNSAMPLING_RATE) / VECTOR_SIZE;
+	const unsigned int decimation_ratio = Decimator::ratio_for_period(adc.get_channel_data_rate(), value_period);
+	const float decimated_period = decimation_ratio / adc.get_channel_data_rate();
+	INFO("ADC %d channel data rate: %d mHz, decimation ratio: %u, %d ms per value",
+		device, static_cast<int>(adc.get_channel_data_rate() * 1000), decimation_ratio,
+		static_cast<int>(decimated_period * 1000));
+	if (std::fabs(decimated_period - value_period) > value_period * DECIMATION_PERIOD_TOLERANCE){
+		WARN("ADC %d window values are %d ms apart instead of %d ms", device,
+			static_cast<int>(decimated_period * 1000), static_cast<int>(value_period * 1000));
+	}
+
+	for (int channel = 0; channel < ADC_CHANNELS; channel++){
+		adc.set_window(channel, WINDOW_LENGTH, WINDOW_HOP);
+	}
+
+	adc.read_voltage_from_channels(decimation_ratio, MEDIAN_WINDOW, SPIKE_THRESHOLD);
 }
 
+#ifndef COOPERATIVE_SCHEDULING
 void send_output_to_data_sink(void){
 
     SerialMailSender& serial_mail_sender = SerialMailSender::getInstance();
 	serial_mail_sender.sendMail();
 
 }
+#endif
+
+template <typename Edge>
+void log_edge_statistics(Edge& edge){
+	const typename Edge::Statistics statistics = edge.get_statistics(true);
+	INFO("Edge %s: depth %lu (max %lu), %lu put, %lu dropped, %lu blocked", edge.get_name(),
+		static_cast<unsigned long>(statistics.depth), static_cast<unsigned long>(statistics.max_depth),
+		static_cast<unsigned long>(statistics.put), static_cast<unsigned long>(statistics.dropped),
+		static_cast<unsigned long>(statistics.blocked));
+}
+
+// Timing of every channel of a converter and the depths and drops of both edges since the previous report
+void log_statistics(int device){
+	AcquisitionStats::Statistics statistics[ADC_CHANNELS];
+	adcs[device]->get_acquisition_statistics(statistics, true);
+	for (int channel = 0; channel < ADC_CHANNELS; channel++) {
+		INFO("ADC %d channel %d: %lu conversions, gap min/mean/max %lu/%lu/%lu us (expected %lu), %lu missed",
+			device, channel, static_cast<unsigned long>(statistics[channel].count),
+			static_cast<unsigned long>(statistics[channel].min_gap_us),
+			static_cast<unsigned long>(statistics[channel].mean_gap_us),
+			static_cast<unsigned long>(statistics[channel].max_gap_us),
+			static_cast<unsigned long>(statistics[channel].expected_gap_us),
+			static_cast<unsigned long>(statistics[channel].missed));
+	}
+	log_edge_statistics(ReadingQueue::getInstance().queue);
+	log_edge_statistics(SendingQueue::getInstance().queue);
+
+#ifdef LOW_POWER_MODE
+	// Share of the time since the previous report spent in sleep and deep sleep
+	mbed_lib::print_sleep_stats();
+#endif
+}
 
-void convertMailToVectors(const ReadingQueue::mail_t &reading_mail,
-                          std::vector<std::array<uint8_t, 3>> &vec_ch0,
-                          std::vector<std::array<uint8_t, 3>> &vec_ch1) {
-    vec_ch0.assign(reading_mail.inputs_ch0.begin(), reading_mail.inputs_ch0.end());
-    vec_ch1.assign(reading_mail.inputs_ch1.begin(), reading_mail.inputs_ch1.end());
+// Preprocesses every due channel of a window and submits its inference
+// Returns the number of jobs submitted, each calls its done callback once
+int classify_window(WindowPool::Buffer* window){
+	InferenceService& inference = InferenceService::getInstance();
+	const int device = window->device;
+
+	// Every due channel is classified by the inference thread, the next channel is
+	// preprocessed meanwhile
+	int submitted = 0;
+	for (int channel = 0; channel < ADC_CHANNELS; channel++) {
+		const int slot = device * ADC_CHANNELS + channel;
+		const std::array<uint8_t, 3>* values = window->inputs[channel].data();
+		const std::size_t length = window->lengths[channel];
+		const std::size_t new_values = window->new_values[channel];
+
+		// Channels whose hop has not elapsed keep their last classification
+		if (new_values != 0) {
+			if (length != window_lengths[slot]) {
+				window_lengths[slot] = length;
+				detrends[slot] = LinearDetrend(window_lengths[slot]);
+			}
+
+			// DETRENDING: O(1) update of the least-squares line per new value
+#ifdef PREPROCESSING_DETRENDING
+			detrends[slot].update(values, length, new_values);
+#endif
+
+			// CONVERSION, DETRENDING AND NORMALIZATION in one pass with adaptive bounds
+#ifdef PREPROCESSING_FIXED_POINT
+			normalizers[slot].process_q15(values, length, new_values, inputs_normalized[channel],
+				detrends[slot].get_offset(), detrends[slot].get_slope());
+#else
+			normalizers[slot].process(values, length, new_values, 1.0, inputs_normalized[channel],
+				detrends[slot].get_offset(), detrends[slot].get_slope());
+#endif
+
+			// Execute Model with received inputs, the result lands in the channel's slot
+			jobs[channel].result = results[slot].data();
+			if (inference.submit(&jobs[channel])) {
+				submitted++;
+			} else {
+				WARN("Inference of ADC %d channel %d not queued", device, channel);
+			}
+		}
+	}
+	return submitted;
 }
 
+// Attaches the classifications to a window whose jobs are done and hands it on to the sender
+void finish_window(WindowPool::Buffer* window){
+	// The classifications are attached to the window in place
+	for (int channel = 0; channel < ADC_CHANNELS; channel++) {
+		window->classification[channel] = results[window->device * ADC_CHANNELS + channel];
+	}
+
+	const int device = window->device;
+
+	// Access the shared queue and hand the window on, the sender releases it
+	SendingQueue& sending_queue = SendingQueue::getInstance();
+	sending_queue.queue.put(window);
+
+	// Statistics of the converter once every STATISTICS_WINDOWS of its windows
+	static unsigned int windows_since_report[ADC_DEVICES] = {0};
+	if (++windows_since_report[device] >= STATISTICS_WINDOWS) {
+		windows_since_report[device] = 0;
+		log_statistics(device);
+	}
+
+	// Stacks and heap of the scheduling mode, once every stage has run
+	static bool memory_reported = false;
+	if (!memory_reported) {
+		memory_reported = true;
+		mbed_lib::print_memory_info(SCHEDULING_MODE);
+	}
+}
+
+#ifdef COOPERATIVE_SCHEDULING
+// Window whose jobs run on the EventLoop, nullptr while none is
+WindowPool::Buffer* classified_window = nullptr;
+int pending_jobs = 0;
+
+// Handler of the EventLoop, posted for every window put on the reading queue. Classifies
+// the next window unless one is being classified, whose last job posts this again.
+void process_windows(void){
+	if (classified_window != nullptr) {
+		return;
+	}
+	WindowPool::Buffer* window = ReadingQueue::getInstance().queue.try_get();
+	if (window == nullptr) {
+		return;
+	}
+	AD7124::resume_parked(); // the window freed a slot of the reading queue
+	classified_window = window;
+	pending_jobs = classify_window(window);
+	if (pending_jobs == 0) {
+		finish_window(window);
+		classified_window = nullptr;
+		EventLoop::getInstance().post(callback(process_windows));
+	}
+}
+
+// Done callback of the jobs, runs on the EventLoop
+void job_done(InferenceService::Job*){
+	if (--pending_jobs == 0) {
+		finish_window(classified_window);
+		classified_window = nullptr;
+		EventLoop::getInstance().post(callback(process_windows));
+	}
+}
+
+// Notify callbacks of the edges, a full loop leaves the window queued until the next one
+void reading_queue_notify(void){
+	if (!EventLoop::getInstance().post(callback(process_windows))) {
+		WARN("Event loop full, window left queued");
+	}
+}
+
+void sending_queue_notify(void){
+	EventLoop& loop = EventLoop::getInstance();
+	if (!loop.post(callback(&SerialMailSender::getInstance(), &SerialMailSender::send_next))) {
+		WARN("Event loop full, mail left queued");
+	}
+}
+#endif
+
 int main()
 {	
-	// Start reading data from ADC Thread
-	reading_data_thread.start(callback(get_input_model_values_from_adc));
+	// Every converter on its own chip select, the arbiter shares the SPI bus between them
+#ifdef ADC_SIMULATION
+	AD7124Bus* adc_buses[ADC_DEVICES];
+	for (int device = 0; device < ADC_DEVICES; device++) {
+		adc_buses[device] = new SimulatedAD7124(ADC_SIMULATION_SPEEDUP);
+	}
+	adc_bus_arbiter = new AD7124BusArbiter(adc_buses);
+#else
+	adc_bus_arbiter = new AD7124BusArbiter(SPI_FREQUENCY, adc_cs_pins);
+#endif
+
+	normalizers.reserve(ADC_DEVICES * ADC_CHANNELS);
+	detrends.reserve(ADC_DEVICES * ADC_CHANNELS);
+	for (int slot = 0; slot < ADC_DEVICES * ADC_CHANNELS; slot++) {
+		normalizers.emplace_back(NORMALIZATION_BLOCK_COUNT, NORMALIZATION_BLOCK_LENGTH,
+			NORMALIZATION_MIN_SPAN, DATABITS, VREF, GAIN);
+		detrends.emplace_back(VECTOR_SIZE);
+		results[slot].fill(0.0f);
+		window_lengths[slot] = VECTOR_SIZE;
+	}
+
+#ifdef COOPERATIVE_SCHEDULING
+	// Every stage is a handler of the EventLoop, which the main thread dispatches once
+	// the converters are set up. The edges post their consumers.
+	for (int channel = 0; channel < ADC_CHANNELS; channel++) {
+		jobs[channel].window = &inputs_normalized[channel];
+		jobs[channel].model = 0;
+		jobs[channel].done = callback(job_done);
+	}
+	ReadingQueue::getInstance().queue.set_notify(callback(reading_queue_notify));
+	SendingQueue::getInstance().queue.set_notify(callback(sending_queue_notify));
 
-	std::vector<std::array<uint8_t, 3>> inputs_ch1 = {
-			{0x01, 0x02, 0x03},
-			{0x04, 0x05, 0x06},
-			{0x07, 0x08, 0x09}
-		};
+	// Configuration and calibration run here, one converter after the other
+	for (int device = 0; device < ADC_DEVICES; device++) {
+		get_input_model_values_from_adc(device);
+	}
+
+	EventLoop::getInstance().dispatch();
+#else
+	// The inference thread releases jobs_done once per finished job
+	Semaphore jobs_done(0);
+	for (int channel = 0; channel < ADC_CHANNELS; channel++) {
+		jobs[channel].window = &inputs_normalized[channel];
+		jobs[channel].model = 0;
+		jobs[channel].done = [&jobs_done](InferenceService::Job*) { jobs_done.release(); };
+	}
+
+	// Start one thread reading data from each ADC
+	for (int device = 0; device < ADC_DEVICES; device++) {
+		reading_data_threads[device].start([device]() { get_input_model_values_from_adc(device); });
+	}
 
 	// Start sending Thread
 	sending_data_thread.start(callback(send_output_to_data_sink));
 
     while (true) {
-		// Access the shared ReadingQueue instance
-		reading_mutex.lock();
+		// Access the shared ReadingQueue instance and sleep until the next window arrives.
+		// The pooled buffer is processed in place and handed on to the sender.
 		ReadingQueue& reading_queue = ReadingQueue::getInstance();
-		ReadingQueue::mail_t *reading_mail = reading_queue.mail_box.try_get();
-		std::vector<std::array<uint8_t, 3>> inputs_as_bytes_ch0; 
-		std::vector<std::array<uint8_t, 3>> inputs_as_bytes_ch1;
-		if (reading_mail != nullptr) {
-			convertMailToVectors(*reading_mail, inputs_as_bytes_ch0, inputs_as_bytes_ch1);
-			reading_queue.mail_box.free(reading_mail);
-		}
-		else{
-			reading_mutex.unlock();
-			continue;
-		}
-		reading_mutex.unlock();
-
-		// Instantiate and initialize the model executor
-		ModelExecutor& executor = ModelExecutor::getInstance(16384); // Pass the desired pool size
-
-			
-		std::vector<float> inputs_ch0_mv = get_analog_inputs(inputs_as_bytes_ch0, DATABITS, VREF, GAIN);
-		std::vector<float> inputs_ch1_mv = get_analog_inputs(inputs_as_bytes_ch1, DATABITS, VREF, GAIN);
-
-		// NORMALIZATION
-		std::vector<float> inputs_ch0_normalized = Preprocessing::minMaxNormalization(
-			inputs_ch0_mv,
-			-0.2,
-			0.2,
-			1.0);
-		std::vector<float> inputs_ch1_normalized = Preprocessing::minMaxNormalization(
-			inputs_ch1_mv,
-			-0.2,
-			0.2,
-			1.0);
-			
-
-		// Execute Model with received inputs
-		std::vector<float> results_ch0 = executor.run_model(inputs_ch0_normalized);
-		std::vector<float> results_ch1 = executor.run_model(inputs_ch1_normalized);
-
-		sending_mutex.lock();
-		// Access the shared queue
-		SendingQueue& sending_queue = SendingQueue::getInstance();
-
-		while (!sending_queue.mail_box.empty()) {
-			sending_mutex.unlock();
-			thread_sleep_for(1); // Allow the consumer to catch up.
-			sending_mutex.lock();
-		}
+		WindowPool::Buffer* window = reading_queue.queue.get();
+
+		const int submitted = classify_window(window);
 
-		// Now, when the mailbox is empty, allocate a new mail slot.
-    	SendingQueue::mail_t* sending_mail = sending_queue.mail_box.try_alloc_for(rtos::Kernel::Clock::duration_u32::max());
-		if (sending_mail) {
-			std::copy(inputs_as_bytes_ch0.begin(), inputs_as_bytes_ch0.end(), sending_mail->inputs_ch0.begin());
-        	std::copy(inputs_as_bytes_ch1.begin(), inputs_as_bytes_ch1.end(), sending_mail->inputs_ch1.begin());
-			std::copy(results_ch0.begin(), results_ch0.end(), sending_mail->classification_ch0.begin());
-        	std::copy(results_ch1.begin(), results_ch1.end(), sending_mail->classification_ch1.begin());
-			sending_queue.mail_box.put(sending_mail); 
+		// Sleep until every job of this window is done
+		for (int job = 0; job < submitted; job++) {
+			jobs_done.acquire();
 		}
-		sending_mutex.unlock();
 
-	
+		finish_window(window);
 	}
+#endif
 
 	// main() is expected to loop forever.
 	// If main() actually returns the processor will halt
@@ -0,0 +1,91 @@
+#include "model_executor/InferenceService.h"
+#include "model_executor/ModelExecutor.h"
+#include "interfaces/EventLoop.h"
+#include <algorithm>
+
+// Inference thread, its stack holds the model execution that used to run on the main thread
+#define INFERENCE_THREAD_STACK_SIZE 4096
+#define INFERENCE_THREAD_PRIORITY osPriorityBelowNormal
+
+// Bytes of the ExecuTorch method allocator
+#define INFERENCE_ALLOCATOR_POOL_SIZE 16384
+
+InferenceService& InferenceService::getInstance(void) {
+    static InferenceService instance;
+    return instance;
+}
+
+#ifdef COOPERATIVE_SCHEDULING
+InferenceService::InferenceService(void) {
+#else
+InferenceService::InferenceService(void):
+    m_queue(PRIORITIES * QUEUE_DEPTH * EVENTS_EVENT_SIZE),
+    m_thread(INFERENCE_THREAD_PRIORITY, INFERENCE_THREAD_STACK_SIZE, nullptr, "inference") {
+#endif
+
+    for (int priority = 0; priority < PRIORITIES; priority++) {
+        m_pending_head[priority] = 0;
+        m_pending_count[priority] = 0;
+    }
+#ifndef COOPERATIVE_SCHEDULING
+    m_thread.start(callback(&m_queue, &EventQueue::dispatch_forever));
+#endif
+}
+
+bool InferenceService::submit(Job* job, Priority priority) {
+    if (job->model >= MODELS) {
+        return false;
+    }
+    const int level = static_cast<int>(priority);
+
+    CriticalSectionLock lock;
+    if (m_pending_count[level] == QUEUE_DEPTH) {
+        return false;
+    }
+#ifdef COOPERATIVE_SCHEDULING
+    if (!EventLoop::getInstance().post(callback(this, &InferenceService::run_next))) {
+        return false;
+    }
+#else
+    if (m_queue.call(callback(this, &InferenceService::run_next)) == 0) {
+        return false;
+    }
+#endif
+    m_pending[level][(m_pending_head[level] + m_pending_count[level]) % QUEUE_DEPTH] = job;
+    m_pending_count[level]++;
+    return true;
+}
+
+/**
+ * Events and jobs are counted alike, so every event finds a job. Which one is
+ * decided only now, which lets later urgent jobs overtake.
+ */
+void InferenceService::run_next(void) {
+    Job* job = nullptr;
+    {
+        CriticalSectionLock lock;
+        for (int level = 0; level < PRIORITIES && job == nullptr; level++) {
+            if (m_pending_count[level] > 0) {
+                job = m_pending[level][m_pending_head[level]];
+                m_pending_head[level] = (m_pending_head[level] + 1) % QUEUE_DEPTH;
+                m_pending_count[level]--;
+            }
+        }
+    }
+    if (job == nullptr) {
+        return;
+    }
+
+    ModelExecutor& executor = ModelExecutor::getInstance(INFERENCE_ALLOCATOR_POOL_SIZE);
+#ifdef PREPROCESSING_FIXED_POINT
+    // Q15 is converted to float in the input tensor
+    const std::vector<float> result = executor.run_model(*job->window, 1.0);
+#else
+    const std::vector<float> result = executor.run_model(*job->window);
+#endif
+    std::copy_n(result.begin(), std::min<std::size_t>(result.size(), CLASSES), job->result);
+
+    if (job->done) {
+        job->done(job);
+    }
+}
@@ -78,7 +78,49 @@ ModelExecutor& ModelExecutor::getInstance(size_t pool_size) {
     return instance;
 }
 
-std::vector<float> ModelExecutor::run_model(std::vector<float> feature_vector){
+namespace {
+
+// A window shorter than the model input fills its newest positions, the older ones are zero.
+// A longer window contributes its newest values.
+struct FloatInputs {
+	const std::vector<float>& values;
+
+	void write(float* data, int count) {
+		const int size = static_cast<int>(values.size());
+		for(int j = 0; j < count; ++j){
+			const int index = size - count + j;
+			data[j] = (index >= 0) ? values[index] : 0.0f;
+		}
+	}
+};
+
+struct Q15Inputs {
+	const std::vector<q15_t>& values;
+	float factor;
+
+	void write(float* data, int count) {
+		const float scale = factor / Q15_ONE;
+		const int size = static_cast<int>(values.size());
+		for(int j = 0; j < count; ++j){
+			const int index = size - count + j;
+			data[j] = (index >= 0) ? static_cast<float>(values[index]) * scale : 0.0f;
+		}
+	}
+};
+
+} // namespace
+
+std::vector<float> ModelExecutor::run_model(const std::vector<float>& feature_vector){
+	FloatInputs inputs = {feature_vector};
+	return execute(callback(&inputs, &FloatInputs::write));
+}
+
+std::vector<float> ModelExecutor::run_model(const std::vector<q15_t>& feature_vector, float factor){
+	Q15Inputs inputs = {feature_vector, factor};
+	return execute(callback(&inputs, &Q15Inputs::write));
+}
+
+std::vector<float> ModelExecutor::execute(Callback<void(float*, int)> write_inputs){
 
 		torch::executor::runtime_init();
 
@@ -188,9 +230,7 @@ std::vector<float> ModelExecutor::run_model(std::vector<float> feature_vector){
 		ET_LOG(Info, "Number of input values required by model:%d", tensor.numel());
 
     	// Change input
-    	for(int j = 0; j < tensor.numel(); ++j){
-        	data[j] = feature_vector[j];
-    	}
+    	write_inputs(data, tensor.numel());
 
 		// Set input 
 		method->set_input(input_original,0);
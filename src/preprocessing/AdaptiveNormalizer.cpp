@@ -0,0 +1,105 @@
+#include "preprocessing/AdaptiveNormalizer.h"
+#include "preprocessing/Normalization.h"
+#include <algorithm>
+#include <cmath>
+
+// A raw value minus the line at index i. The value is subtracted from the offset first: both are
+// close for a fitted line, so the difference is exact, whereas offset + slope * i would be rounded
+// to the 24 bits of a float at the full scale magnitude of the offset.
+static inline float detrended(const std::array<uint8_t, 3>& bytes, float trend_offset, float trend_slope, std::size_t i) {
+    return (static_cast<float>(bytes_to_q31(bytes)) - trend_offset) - trend_slope * static_cast<float>(i);
+}
+
+AdaptiveNormalizer::AdaptiveNormalizer(std::size_t block_count, std::size_t block_length, float min_span,
+                                       int databits, float vref, float gain)
+    : m_min_max(block_count, block_length), m_min_span(0.0f), m_mv_per_unit(0.0f) {
+
+    // A Q31 value is the 24-bit code shifted left by 8 bits.
+    m_mv_per_unit = (vref / gain) * 1000.0f / static_cast<float>(databits) / 256.0f;
+    m_min_span = min_span / m_mv_per_unit;
+}
+
+// Bounds in Q31 units, widened to the minimum span around their centre.
+void AdaptiveNormalizer::get_bounds(float& lower, float& upper) const {
+    lower = m_min_max.getMinValue();
+    upper = m_min_max.getMaxValue();
+    if (upper - lower < m_min_span) {
+        float centre = 0.5f * (lower + upper);
+        lower = centre - 0.5f * m_min_span;
+        upper = centre + 0.5f * m_min_span;
+    }
+}
+
+float AdaptiveNormalizer::get_min(void) const {
+    float lower, upper;
+    get_bounds(lower, upper);
+    return lower * m_mv_per_unit;
+}
+
+float AdaptiveNormalizer::get_max(void) const {
+    float lower, upper;
+    get_bounds(lower, upper);
+    return upper * m_mv_per_unit;
+}
+
+// Only the values that entered the window since the last call extend the horizon.
+void AdaptiveNormalizer::update_from_window(const std::array<uint8_t, 3>* window, std::size_t length, std::size_t new_values,
+                                            float trend_offset, float trend_slope) {
+    std::size_t first_new = length - std::min(new_values, length);
+    for (std::size_t i = first_new; i < length; i++) {
+        m_min_max.update(detrended(window[i], trend_offset, trend_slope, i));
+    }
+}
+
+void AdaptiveNormalizer::process(const std::array<uint8_t, 3>* window, std::size_t length, std::size_t new_values,
+                                 float factor, std::vector<float>& outputs,
+                                 float trend_offset, float trend_slope) {
+    update_from_window(window, length, new_values, trend_offset, trend_slope);
+
+    outputs.resize(length);
+    float lower, upper;
+    get_bounds(lower, upper);
+    if (!m_min_max.hasValues() || upper <= lower) {
+        std::fill(outputs.begin(), outputs.end(), 0.0f);
+        return;
+    }
+
+    // Single pass: each raw value is detrended, clamped to the bounds and scaled straight into the output.
+    // The line is evaluated per index rather than accumulated, which would add up rounding errors.
+    const float scale = factor / (upper - lower);
+    for (std::size_t i = 0; i < length; i++) {
+        const float residual = std::max(lower, std::min(upper, detrended(window[i], trend_offset, trend_slope, i)));
+        outputs[i] = (residual - lower) * scale;
+    }
+}
+
+void AdaptiveNormalizer::process_q15(const std::array<uint8_t, 3>* window, std::size_t length, std::size_t new_values,
+                                     std::vector<q15_t>& outputs,
+                                     float trend_offset, float trend_slope) {
+    update_from_window(window, length, new_values, trend_offset, trend_slope);
+
+    outputs.resize(length);
+    float lower, upper;
+    get_bounds(lower, upper);
+
+    // Detrended and widened bounds may leave the Q31 range, so they are kept in 64 bits.
+    const int64_t lower_q31 = std::llround(lower);
+    const int64_t upper_q31 = std::llround(upper);
+
+    int64_t reciprocal = Preprocessing::minMaxReciprocal(lower_q31, upper_q31);
+    if (!m_min_max.hasValues() || reciprocal == 0) {
+        std::fill(outputs.begin(), outputs.end(), 0);
+        return;
+    }
+
+    // The line is stepped in Q31 with 16 extra fractional bits, so the pass stays in integers.
+    // Residuals are clamped to the bounds as in process(), which also keeps the products in range.
+    int64_t trend = static_cast<int64_t>(trend_offset * 65536.0f);
+    const int64_t trend_step = static_cast<int64_t>(trend_slope * 65536.0f);
+    for (std::size_t i = 0; i < length; i++) {
+        int64_t residual = static_cast<int64_t>(bytes_to_q31(window[i])) - (trend >> 16);
+        residual = std::max(lower_q31, std::min(upper_q31, residual));
+        outputs[i] = Preprocessing::minMaxNormalizeQ15(residual, lower_q31, reciprocal);
+        trend += trend_step;
+    }
+}
@@ -0,0 +1,146 @@
+#include "preprocessing/Decimator.h"
+#include "mbed.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 63-tap CIC compensation filter in Q15, designed for a fifth order CIC by
+// weighted least squares: passband up to 0.15 and stopband from 0.25 of the
+// CIC output rate, i.e. from the Nyquist frequency of the decimated output.
+// The stopband is below -75 dB. The taps sum to 32768 (unity DC gain).
+// Even taps h[0], h[2], ..., h[62] of the symmetric prototype.
+const int32_t FIR_EVEN_TAPS[32] = {
+    0, 0, 4, -14, 17, 14, -92, 183,
+    -181, -40, 515, -1052, 1192, -279, -2618, 10544,
+    10544, -2618, -279, 1192, -1052, 515, -40, -181,
+    183, -92, 14, 17, -14, 4, 0, 0
+};
+
+// Odd taps h[1], h[3], ..., h[61], zero padded to the phase length.
+const int32_t FIR_ODD_TAPS[32] = {
+    -1, 3, -2, -12, 43, -67, 28, 124,
+    -360, 516, -324, -437, 1728, -3065, 2983, 14068,
+    2983, -3065, 1728, -437, -324, 516, -360, 124,
+    28, -67, 43, -12, -2, 3, -1, 0
+};
+
+const int32_t CODE_MAX = 8388607;
+const int32_t CODE_MIN = -8388608;
+
+int32_t clamp_code(int64_t value) {
+    return static_cast<int32_t>(std::min<int64_t>(CODE_MAX, std::max<int64_t>(CODE_MIN, value)));
+}
+
+} // namespace
+
+Decimator::Decimator(unsigned int decimation_ratio)
+    : m_ratio(decimation_ratio), m_cic_ratio(m_ratio / 2), m_cic_gain(1) {
+
+    // The FIR decimates by 2, an odd ratio would silently change the output rate
+    MBED_ASSERT(m_ratio >= 2 && m_ratio <= MAX_RATIO && m_ratio % 2 == 0);
+    for (int i = 0; i < CIC_ORDER; i++) {
+        m_cic_gain *= m_cic_ratio;
+    }
+    reset();
+}
+
+void Decimator::reset(void) {
+    m_integrators.fill(0);
+    m_combs.fill(0);
+    m_cic_phase = 0;
+    m_even_delay.fill(0);
+    m_odd_delay.fill(0);
+    m_delay_index = 0;
+    m_odd_sample = false;
+}
+
+unsigned int Decimator::get_ratio(void) const {
+    return m_ratio;
+}
+
+unsigned int Decimator::ratio_for_period(float input_rate, float output_period) {
+    const float half_ratio = std::round(input_rate * output_period / 2.0f);
+    return 2 * static_cast<unsigned int>(std::min<float>(MAX_RATIO / 2, std::max(1.0f, half_ratio)));
+}
+
+/**
+ * @brief Pushes one sample through the CIC integrators and, every m_cic_ratio
+ * samples, through the comb section.
+ *
+ * The registers wrap around modulo 2^64, which is harmless because the comb
+ * section cancels the wrap as long as the true output fits into the register.
+ * The output is divided by the CIC gain, so it keeps the 24-bit input scale.
+ */
+bool Decimator::cic_push(int32_t sample, int32_t& output) {
+    uint64_t value = static_cast<uint64_t>(static_cast<int64_t>(sample));
+    for (int i = 0; i < CIC_ORDER; i++) {
+        m_integrators[i] += value;
+        value = m_integrators[i];
+    }
+
+    if (++m_cic_phase < m_cic_ratio) {
+        return false;
+    }
+    m_cic_phase = 0;
+
+    for (int i = 0; i < CIC_ORDER; i++) {
+        uint64_t delayed = m_combs[i];
+        m_combs[i] = value;
+        value -= delayed;
+    }
+
+    int64_t sum = static_cast<int64_t>(value);
+    int64_t half_gain = m_cic_gain / 2;
+    int64_t scaled = (sum >= 0) ? (sum + half_gain) / m_cic_gain : -((-sum + half_gain) / m_cic_gain);
+    output = clamp_code(scaled);
+    return true;
+}
+
+/**
+ * @brief Pushes one CIC output into the polyphase FIR filter.
+ *
+ * Odd samples are only stored. Every even sample produces one output, which
+ * is the sum of both branches: the even taps run over the even samples and
+ * the odd taps over the odd samples, so only half of the products of a full
+ * rate FIR are computed.
+ */
+bool Decimator::fir_push(int32_t sample, int32_t& output) {
+    if (m_odd_sample) {
+        m_odd_delay[m_delay_index] = sample;
+        m_odd_sample = false;
+        return false;
+    }
+
+    m_delay_index = (m_delay_index + 1) % FIR_PHASE_LENGTH;
+    m_even_delay[m_delay_index] = sample;
+    m_odd_sample = true;
+
+    int64_t accumulator = 0;
+    std::size_t even_index = m_delay_index;
+    std::size_t odd_index = (m_delay_index + FIR_PHASE_LENGTH - 1) % FIR_PHASE_LENGTH;
+    for (std::size_t i = 0; i < FIR_PHASE_LENGTH; i++) {
+        accumulator += static_cast<int64_t>(FIR_EVEN_TAPS[i]) * m_even_delay[even_index];
+        accumulator += static_cast<int64_t>(FIR_ODD_TAPS[i]) * m_odd_delay[odd_index];
+        even_index = (even_index + FIR_PHASE_LENGTH - 1) % FIR_PHASE_LENGTH;
+        odd_index = (odd_index + FIR_PHASE_LENGTH - 1) % FIR_PHASE_LENGTH;
+    }
+
+    output = clamp_code((accumulator + (1 << 14)) >> 15);
+    return true;
+}
+
+std::size_t Decimator::process(const int32_t* inputs, std::size_t count, int32_t* outputs) {
+    std::size_t produced = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        int32_t cic_output = 0;
+        if (!cic_push(inputs[i], cic_output)) {
+            continue;
+        }
+        int32_t fir_output = 0;
+        if (fir_push(cic_output, fir_output)) {
+            outputs[produced++] = fir_output;
+        }
+    }
+    return produced;
+}
@@ -0,0 +1,64 @@
+#include "preprocessing/LinearDetrend.h"
+#include <algorithm>
+
+LinearDetrend::LinearDetrend(std::size_t window_size)
+    : m_window(std::max<std::size_t>(1, window_size), 0), m_size(std::max<std::size_t>(1, window_size)),
+      m_count(0), m_oldest(0), m_sum_x(0), m_sum_xt(0), m_offset(0.0f), m_slope(0.0f) {}
+
+void LinearDetrend::update(q31_t value) {
+    if (m_count < m_size) {
+        // Window is still filling up: the new value gets the next free position.
+        m_sum_xt += static_cast<int64_t>(value) * static_cast<int64_t>(m_count);
+        m_sum_x += value;
+        m_window[(m_oldest + m_count) % m_size] = value;
+        m_count++;
+    } else {
+        // Dropping the oldest value shifts every position down by one, which lowers
+        // Σxt by the sum of the remaining values. The new value takes position n - 1.
+        q31_t oldest = m_window[m_oldest];
+        m_sum_x -= oldest;
+        m_sum_xt -= m_sum_x;
+        m_sum_xt += static_cast<int64_t>(value) * static_cast<int64_t>(m_size - 1);
+        m_sum_x += value;
+        m_window[m_oldest] = value;
+        m_oldest = (m_oldest + 1) % m_size;
+    }
+    fit();
+}
+
+void LinearDetrend::update(const std::array<uint8_t, 3>* window, std::size_t length, std::size_t new_values) {
+    std::size_t first_new = length - std::min(new_values, length);
+    for (std::size_t i = first_new; i < length; i++) {
+        update(bytes_to_q31(window[i]));
+    }
+}
+
+/**
+ * Centred form of the normal equations, which avoids the cancellation of the
+ * textbook form n·Σxt - Σt·Σx:
+ *   Sxt = Σxt - Σt·Σx / n = (2·Σxt - (n - 1)·Σx) / 2   (exact in 64 bits)
+ *   Stt = Σt² - (Σt)² / n = n·(n² - 1) / 12
+ * The slope is Sxt / Stt and the line passes through (mean t, mean x).
+ */
+void LinearDetrend::fit(void) {
+    if (m_count < 2) {
+        m_slope = 0.0f;
+        m_offset = (m_count == 1) ? static_cast<float>(m_sum_x) : 0.0f;
+        return;
+    }
+
+    const int64_t n = static_cast<int64_t>(m_count);
+    const int64_t twice_sxt = 2 * m_sum_xt - (n - 1) * m_sum_x;
+    const float stt = static_cast<float>(n) * static_cast<float>(n * n - 1) / 12.0f;
+
+    m_slope = static_cast<float>(twice_sxt) / (2.0f * stt);
+    m_offset = static_cast<float>(m_sum_x) / static_cast<float>(n) - m_slope * 0.5f * static_cast<float>(n - 1);
+}
+
+float LinearDetrend::get_offset(void) const {
+    return m_offset;
+}
+
+float LinearDetrend::get_slope(void) const {
+    return m_slope;
+}
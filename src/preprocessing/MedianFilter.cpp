@@ -0,0 +1,112 @@
+#include "preprocessing/MedianFilter.h"
+
+MedianFilter::MedianFilter(std::size_t window_size, int32_t spike_threshold)
+    : m_samples(window_size, 0), m_counts{0, 0}, m_half(window_size, LOWER), m_position(window_size, 0),
+      m_size(static_cast<int>(window_size)), m_count(0), m_index(0), m_spike_threshold(spike_threshold) {
+
+    m_halves[LOWER].resize((window_size + 1) / 2);
+    m_halves[UPPER].resize(window_size / 2);
+}
+
+bool MedianFilter::above(int half, int32_t a, int32_t b) const {
+    return (half == LOWER) ? a > b : a < b;
+}
+
+int32_t MedianFilter::top(int half) const {
+    return m_samples[m_halves[half][0]];
+}
+
+void MedianFilter::place(int half, int position, int slot) {
+    m_halves[half][position] = slot;
+    m_half[slot] = static_cast<uint8_t>(half);
+    m_position[slot] = position;
+}
+
+void MedianFilter::sift_up(int half, int position) {
+    const int slot = m_halves[half][position];
+    while (position > 0) {
+        const int parent = (position - 1) / 2;
+        if (!above(half, m_samples[slot], m_samples[m_halves[half][parent]])) {
+            break;
+        }
+        place(half, position, m_halves[half][parent]);
+        position = parent;
+    }
+    place(half, position, slot);
+}
+
+void MedianFilter::sift_down(int half, int position) {
+    const int slot = m_halves[half][position];
+    const int count = m_counts[half];
+    while (true) {
+        int child = 2 * position + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && above(half, m_samples[m_halves[half][child + 1]], m_samples[m_halves[half][child]])) {
+            child++;
+        }
+        if (!above(half, m_samples[m_halves[half][child]], m_samples[slot])) {
+            break;
+        }
+        place(half, position, m_halves[half][child]);
+        position = child;
+    }
+    place(half, position, slot);
+}
+
+/**
+ * While the window fills, a new slot joins the half that keeps the lower one at most one
+ * slot larger. Once it is full, the oldest slot takes the new sample and is sifted within
+ * its half. Either way only the tops can end up on the wrong side of the median: every other
+ * sample of the lower half is at most the old top of the upper half and vice versa, so
+ * exchanging the tops restores the order.
+ */
+int32_t MedianFilter::update(int32_t sample) {
+    if (m_size < 2) {
+        return sample;
+    }
+
+    const int slot = m_index;
+    m_index = (m_index + 1) % m_size;
+    m_samples[slot] = sample;
+
+    if (m_count < m_size) {
+        const int half = (m_counts[LOWER] > m_counts[UPPER]) ? UPPER : LOWER;
+        place(half, m_counts[half]++, slot);
+        sift_up(half, m_position[slot]);
+        m_count++;
+    } else {
+        sift_up(m_half[slot], m_position[slot]);
+        sift_down(m_half[slot], m_position[slot]);
+    }
+
+    if (m_counts[UPPER] > 0 && top(LOWER) > top(UPPER)) {
+        const int lower_top = m_halves[LOWER][0];
+        place(LOWER, 0, m_halves[UPPER][0]);
+        place(UPPER, 0, lower_top);
+        sift_down(LOWER, 0);
+        sift_down(UPPER, 0);
+    }
+
+    int32_t median = get_median();
+    if (m_spike_threshold > 0) {
+        int32_t deviation = (sample > median) ? sample - median : median - sample;
+        if (deviation <= m_spike_threshold) {
+            return sample;
+        }
+    }
+    return median;
+}
+
+int32_t MedianFilter::get_median(void) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    const int32_t lower = top(LOWER);
+    if (m_counts[LOWER] > m_counts[UPPER]) {
+        return lower;
+    }
+    // Average of the two middle values, computed without overflow.
+    return lower + (top(UPPER) - lower) / 2;
+}
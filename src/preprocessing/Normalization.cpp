@@ -1,6 +1,7 @@
 #include "preprocessing/Normalization.h"
 #include <cmath>
 #include <numeric> 
+#include <algorithm>
 
 std::vector<float> Preprocessing::minMaxNormalization(std::vector<float> inputs, float minValue, float maxValue, float factor) {
     if (inputs.empty()) return {}; // Handle empty input case
@@ -64,4 +65,22 @@ std::array<uint8_t, 3> Preprocessing::computeMean(std::vector<std::array<uint8_t
     return {static_cast<uint8_t>((sum_0 + size / 2) / size), 
             static_cast<uint8_t>((sum_1 + size / 2) / size), 
             static_cast<uint8_t>((sum_2 + size / 2) / size)};
-}
\ No newline at end of file
+}
+
+// Returns 2^61 / (maxValue - minValue), so that a difference times the reciprocal,
+// shifted right by 46, is the difference relative to the range in Q15.
+// The truncation of the reciprocal stays far below 1 LSB of the Q15 result for any
+// range of detrended Q31 values. Differences from -range to 2 * range keep every
+// product within 2^62; values further out saturate anyway and are clamped by the caller.
+int64_t Preprocessing::minMaxReciprocal(int64_t minValue, int64_t maxValue) {
+    int64_t range = maxValue - minValue;
+    if (range <= 0) {
+        return 0;
+    }
+    return (static_cast<int64_t>(1) << 61) / range;
+}
+
+q15_t Preprocessing::minMaxNormalizeQ15(int64_t value, int64_t minValue, int64_t reciprocal) {
+    // Rounded to nearest like the float path rounded to Q15, a plain shift would truncate
+    return saturate_q15(((value - minValue) * reciprocal + (static_cast<int64_t>(1) << 45)) >> 46);
+}
@@ -1,53 +1,57 @@
 #include "preprocessing/OnlineMinMax.h"
-#include <algorithm>  // For std::min_element and std::max_element
+#include <algorithm>  // For std::min and std::max
 #include <limits>     // For std::numeric_limits
-#include <iostream>
 
-// Constructor: initializes a fixed-size window, starting index, and count.
-OnlineMinMax::OnlineMinMax(std::size_t windowSize)
-    : window(windowSize, 0.0f), windowSize(windowSize), currentIndex(0), count(0)
+// Constructor: reserves one min/max pair per block, starting with an empty horizon.
+OnlineMinMax::OnlineMinMax(std::size_t blockCount, std::size_t blockLength)
+    : blockMin(std::max<std::size_t>(1, blockCount), std::numeric_limits<float>::max()),
+      blockMax(std::max<std::size_t>(1, blockCount), std::numeric_limits<float>::lowest()),
+      blockCount(std::max<std::size_t>(1, blockCount)), blockLength(std::max<std::size_t>(1, blockLength)),
+      currentBlock(0), completedBlocks(0),
+      currentMin(std::numeric_limits<float>::max()), currentMax(std::numeric_limits<float>::lowest()),
+      currentCount(0)
 {
-    // The window vector is pre-filled with windowSize elements.
 }
 
-// The update method writes each new value into the circular buffer.
-void OnlineMinMax::update(std::vector<float> arr) {
+// The update method folds each new value into the current block. A full block
+// overwrites the oldest completed block, so the horizon slides block by block.
+void OnlineMinMax::update(float value) {
+    currentMin = std::min(currentMin, value);
+    currentMax = std::max(currentMax, value);
+    currentCount++;
 
-    if (count < windowSize - arr.size() + 1) {
-        std::copy(arr.begin(), arr.end(), window.begin() + count);
-        count++;
-    } else{
-        //Move all values in widow to the left the last values are filled with arr
-        std::copy(window.begin() + 1, window.end(), window.begin());
-        window.back() = arr.back();
-        count = windowSize;
+    if (currentCount == blockLength) {
+        blockMin[currentBlock] = currentMin;
+        blockMax[currentBlock] = currentMax;
+        currentBlock = (currentBlock + 1) % blockCount;
+        completedBlocks = std::min(completedBlocks + 1, blockCount);
 
+        currentMin = std::numeric_limits<float>::max();
+        currentMax = std::numeric_limits<float>::lowest();
+        currentCount = 0;
     }
 }
 
-// Returns the maximum value in the current window.
-// During the initial phase (if count < windowSize), only valid elements are considered.
+// Returns the maximum value in the current horizon.
+// If no valid data, returns the lowest possible float.
 float OnlineMinMax::getMaxValue() const {
-    if (count == 0) {
-        // No valid data; return the lowest possible float.
-        return std::numeric_limits<float>::lowest();
-    }
-    if (count < windowSize) {
-        return *std::max_element(window.begin(), window.begin() + count + 1);
-    } else {
-        return *std::max_element(window.begin(), window.end());
+    float maxValue = currentMax;
+    for (std::size_t i = 0; i < completedBlocks; i++) {
+        maxValue = std::max(maxValue, blockMax[i]);
     }
+    return maxValue;
 }
 
-// Returns the minimum value in the current window.
+// Returns the minimum value in the current horizon.
 // If no valid data, returns the maximum possible float.
 float OnlineMinMax::getMinValue() const {
-    if (count == 0) {
-        return std::numeric_limits<float>::max();
-    }
-    if (count < windowSize) {
-        return *std::min_element(window.begin(), window.begin() + count + 1);
-    } else {
-        return *std::min_element(window.begin(), window.end());
+    float minValue = currentMin;
+    for (std::size_t i = 0; i < completedBlocks; i++) {
+        minValue = std::min(minValue, blockMin[i]);
     }
-}
\ No newline at end of file
+    return minValue;
+}
+
+bool OnlineMinMax::hasValues() const {
+    return completedBlocks > 0 || currentCount > 0;
+}
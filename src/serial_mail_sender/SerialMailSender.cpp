@@ -1,5 +1,6 @@
 #include "serial_mail_sender/SerialMailSender.h"
-#include "utils/sending_mutex.h"
+#include <cstring>
+#include "utils/logger.h"
 
 #define BAUDRATE 115200
 
@@ -15,105 +16,83 @@ SerialMailSender& SerialMailSender::getInstance(void) {
 }
 
 // Private constructor
-SerialMailSender::SerialMailSender(void) {
+SerialMailSender::SerialMailSender(void): m_builder(1024) {
     m_serial_port.set_format(8, BufferedSerial::None, 1);  // 8N1 format
+#ifdef LOW_POWER_MODE
+    // The node only transmits, an enabled receiver holds the deep sleep lock
+    m_serial_port.enable_input(false);
+#endif
 }
 
-// Function to convert inputs to SerialMail::Value array
-std::vector<SerialMail::Value> SerialMailSender::convertToSerialMailValues(const std::vector<std::array<uint8_t, 3>>& inputs) {
-    std::vector<SerialMail::Value> raw_input_bytes;
-    raw_input_bytes.reserve(inputs.size()); // Reserve space for efficiency
+// Raw values are copied into the FlatBuffer as they are
+static_assert(sizeof(SerialMail::Value) == sizeof(std::array<uint8_t, 3>), "SerialMail::Value must be three bytes");
 
-    for (const auto& input : inputs) {
-        // Create SerialMail::Value from each 3-byte array
-        raw_input_bytes.emplace_back(SerialMail::Value(input[0], input[1], input[2]));
-    }
+// Serialize and send the SerialMail data
+void SerialMailSender::sendMail(void) {
 
-    return raw_input_bytes;
+    while(true){
+        // Sleep until the main thread puts the next classified window
+        SendingQueue& sending_queue = SendingQueue::getInstance();
+        send(sending_queue.queue.get());
+    }
 }
 
-void SerialMailSender::convertMailToVectors(const SendingQueue::mail_t &sending_mail,
-                          std::vector<std::array<uint8_t, 3>> &vec_ch0,
-                          std::vector<std::array<uint8_t, 3>> &vec_ch1) {
-    vec_ch0.assign(sending_mail.inputs_ch0.begin(), sending_mail.inputs_ch0.end());
-    vec_ch1.assign(sending_mail.inputs_ch1.begin(), sending_mail.inputs_ch1.end());
+bool SerialMailSender::send_next(void) {
+    SendingQueue& sending_queue = SendingQueue::getInstance();
+    WindowPool::Buffer* window = sending_queue.queue.try_get();
+    if (window == nullptr) {
+        return false;
+    }
+    send(window);
+    return true;
 }
 
-void SerialMailSender::convertMailToFloatVectors(const SendingQueue::mail_t &sending_mail,
-                                                 std::vector<float> &vec_ch0,
-                                                 std::vector<float> &vec_ch1) {
-    vec_ch0.assign(sending_mail.classification_ch0.begin(), sending_mail.classification_ch0.end());
-    vec_ch1.assign(sending_mail.classification_ch1.begin(), sending_mail.classification_ch1.end());
-}
+void SerialMailSender::send(WindowPool::Buffer* window) {
 
-// Serialize and send the SerialMail data
-void SerialMailSender::sendMail(void) {
+    // The builder keeps its buffer across mails, Clear() only resets it
+    m_builder.Clear();
 
-    while(true){
-        sending_mutex.lock();
-        SendingQueue& sending_queue = SendingQueue::getInstance();
-        auto mail = sending_queue.mail_box.try_get();
-        std::vector<std::array<uint8_t, 3>> inputs_as_bytes_ch0; 
-		std::vector<std::array<uint8_t, 3>> inputs_as_bytes_ch1;
-        std::vector<float> classification_values_ch0;
-        std::vector<float> classification_values_ch1;
-		if (mail != nullptr) {
-            convertMailToVectors(*mail, inputs_as_bytes_ch0, inputs_as_bytes_ch1);
-            convertMailToFloatVectors(*mail, classification_values_ch0, classification_values_ch1);
-            sending_queue.mail_box.free(mail);
-        }
-        else{
-            sending_mutex.unlock();
-            continue;
-        }
-        sending_mutex.unlock();
-
-        // Prepare the FlatBufferBuilder
-        // FlatBufferBuilder should ideally be re-initialized inside the while loop 
-        // for each iteration, especially if you are processing multiple messages. 
-        // This is because the FlatBufferBuilder does not automatically clear its
-        // internal buffer, and reusing it without clearing can lead to undefined behavior or memory issues.
-        flatbuffers::FlatBufferBuilder builder(1024);
-
-        // Create Flatbuffers vector of bytes
-        std::vector<SerialMail::Value> raw_input_bytes_ch0 = convertToSerialMailValues(inputs_as_bytes_ch0);
-        auto inputs_ch0 = builder.CreateVectorOfStructs(raw_input_bytes_ch0.data(), raw_input_bytes_ch0.size());
-
-        std::vector<SerialMail::Value> raw_input_bytes_ch1 = convertToSerialMailValues(inputs_as_bytes_ch1);
-        auto inputs_ch1 = builder.CreateVectorOfStructs(raw_input_bytes_ch1.data(), raw_input_bytes_ch1.size());
+    // One Channel table per channel, in channel order, serialized straight from the pooled buffer
+    flatbuffers::Offset<SerialMail::Channel> channels[ADC_CHANNELS];
+    for (int channel = 0; channel < ADC_CHANNELS; channel++) {
+        // Create Flatbuffers vector of bytes and fill it in place
+        const std::size_t length = window->lengths[channel];
+        SerialMail::Value* values = nullptr;
+        auto inputs = m_builder.CreateUninitializedVectorOfStructs(length, &values);
+        std::memcpy(reinterpret_cast<uint8_t*>(values), window->inputs[channel].data(), length * sizeof(SerialMail::Value));
 
         // Create Flatbuffers float array
-        auto classification_ch0 = builder.CreateVector(classification_values_ch0.data(), classification_values_ch0.size());
+        auto classification = m_builder.CreateVector(window->classification[channel].data(), CLASSES);
 
-        // Create Flatbuffers float array
-        auto classification_ch1 = builder.CreateVector(classification_values_ch1.data(), classification_values_ch1.size());
+        channels[channel] = SerialMail::CreateChannel(m_builder, inputs, classification);
+    }
 
-        // Channel and Classification active
-        // bool classification_active = sending_mail->classification_active;
-        // bool channel = sending_mail->channel;
+    // Create the SerialMail object
+    auto orc = CreateSerialMail(m_builder, m_builder.CreateVector(channels, ADC_CHANNELS), window->device);
+    m_builder.Finish(orc);
 
-        // Create the SerialMail object
-        auto orc = CreateSerialMail(builder, inputs_ch0, inputs_ch1, classification_ch0, classification_ch1);
-        builder.Finish(orc);
+    // The window is not needed once serialized
+    const int device = window->device;
+    const uint32_t timestamp_us = window->timestamp_us;
+    WindowPool& pool = WindowPool::getInstance();
+    pool.release(window);
 
-        // Get the buffer pointer and size
-        uint8_t* buf = builder.GetBufferPointer();
-        uint32_t size = builder.GetSize();
+    // Get the buffer pointer and size
+    uint8_t* buf = m_builder.GetBufferPointer();
+    uint32_t size = m_builder.GetSize();
 
-        // Send a synchronization marker (e.g., 0xAAAA)
-        uint16_t sync_marker = 0xAAAA;
-        m_serial_port.write(reinterpret_cast<const char*>(&sync_marker), sizeof(sync_marker));
+    // Send a synchronization marker (e.g., 0xAAAA)
+    uint16_t sync_marker = 0xAAAA;
+    m_serial_port.write(reinterpret_cast<const char*>(&sync_marker), sizeof(sync_marker));
 
 
-        // Send the size (4 bytes)
-        m_serial_port.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    // Send the size (4 bytes)
+    m_serial_port.write(reinterpret_cast<const char*>(&size), sizeof(size));
 
-        // Send the FlatBuffers buffer
-        m_serial_port.write(reinterpret_cast<const char*>(buf), size);
-        
-        //printf("sent\n");
-        // Free the allocated mail to avoid memory leaks
-        // make mail box empty
-			
-    }
+    // Send the FlatBuffers buffer
+    m_serial_port.write(reinterpret_cast<const char*>(buf), size);
+
+    // Latency of the pipeline, from the hand-off by acquisition until the mail is buffered for transmission
+    INFO("Mail of ADC %d: %lu bytes, %lu us after acquisition", device, static_cast<unsigned long>(size),
+        static_cast<unsigned long>(pool.get_time_us() - timestamp_us));
 }
@@ -1,22 +1,13 @@
 #include "utils/Conversion.h" // Include the header for the function declaration
 
-// Function definition
-std::vector<float> get_analog_inputs(std::vector<std::array<uint8_t,3>> byte_inputs, int databits, float vref, float gain) {
-    /* calculate the analog value from the measurement */
-
-    std::vector<float> inputs;
-
-    for(unsigned int i = 0; i < byte_inputs.size(); i++){
-        int measurement =  (((int)byte_inputs[i][0] << 16)|(int)byte_inputs[i][1] << 8)|((int)byte_inputs[i][2] << 0);
-        float voltage = (float)measurement / (float)databits - 1;
-        voltage = voltage * vref / gain;
-        voltage *= 1000;
-        inputs.push_back(voltage);
-    }
-
-    // for (size_t i = 0; i < inputs.size(); ++i) {
-    //     printf("inputs[%zu] = %.3f\n", i, inputs[i]);  // %.3f prints 3 decimal places
-    // }
-
-    return inputs;
+int32_t bytes_to_signed_code(const std::array<uint8_t,3>& bytes) {
+    int32_t measurement = ((int32_t)bytes[0] << 16) | ((int32_t)bytes[1] << 8) | (int32_t)bytes[2];
+    return measurement - 0x800000;
+}
+
+std::array<uint8_t,3> signed_code_to_bytes(int32_t code) {
+    uint32_t measurement = static_cast<uint32_t>(code + 0x800000) & 0xFFFFFF;
+    return {static_cast<uint8_t>(measurement >> 16),
+            static_cast<uint8_t>(measurement >> 8),
+            static_cast<uint8_t>(measurement)};
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "utils/FileBlockDevice.h"
+
+FileBlockDevice::FileBlockDevice(const char* path, bd_size_t size):
+    m_path(path), m_size(size), m_file(nullptr), m_init_count(0){
+}
+
+FileBlockDevice::~FileBlockDevice(void){
+    if (m_file != nullptr){
+        fclose(m_file);
+    }
+}
+
+int FileBlockDevice::init(void){
+    if (m_init_count++ > 0){
+        return 0;
+    }
+    m_file = fopen(m_path, "r+b");
+    if (m_file == nullptr){
+        // A new device is erased
+        m_file = fopen(m_path, "w+b");
+        if (m_file == nullptr){
+            m_init_count = 0;
+            return -1;
+        }
+        for (bd_size_t i = 0; i < m_size; i++){
+            fputc(0xFF, m_file);
+        }
+        fflush(m_file);
+    }
+    return 0;
+}
+
+int FileBlockDevice::deinit(void){
+    if (m_init_count == 0 || --m_init_count > 0){
+        return 0;
+    }
+    int result = fclose(m_file);
+    m_file = nullptr;
+    return result == 0 ? 0 : -1;
+}
+
+bool FileBlockDevice::in_range(bd_addr_t address, bd_size_t size) const{
+    return m_file != nullptr && address + size <= m_size;
+}
+
+int FileBlockDevice::read(void* buffer, bd_addr_t address, bd_size_t size){
+    if (!in_range(address, size) || fseek(m_file, static_cast<long>(address), SEEK_SET) != 0){
+        return -1;
+    }
+    return fread(buffer, 1, size, m_file) == size ? 0 : -1;
+}
+
+int FileBlockDevice::program(const void* buffer, bd_addr_t address, bd_size_t size){
+    if (!in_range(address, size) || fseek(m_file, static_cast<long>(address), SEEK_SET) != 0){
+        return -1;
+    }
+    if (fwrite(buffer, 1, size, m_file) != size){
+        return -1;
+    }
+    return fflush(m_file) == 0 ? 0 : -1;
+}
+
+int FileBlockDevice::erase(bd_addr_t address, bd_size_t size){
+    if (!in_range(address, size) || fseek(m_file, static_cast<long>(address), SEEK_SET) != 0){
+        return -1;
+    }
+    for (bd_size_t i = 0; i < size; i++){
+        fputc(0xFF, m_file);
+    }
+    return fflush(m_file) == 0 ? 0 : -1;
+}
+
+bd_size_t FileBlockDevice::get_read_size(void) const{
+    return 1;
+}
+
+bd_size_t FileBlockDevice::get_program_size(void) const{
+    return 1;
+}
+
+bd_size_t FileBlockDevice::get_erase_size(void) const{
+    return 1;
+}
+
+bd_size_t FileBlockDevice::size(void) const{
+    return m_size;
+}
+
+const char* FileBlockDevice::get_type(void) const{
+    return "FILE";
+}
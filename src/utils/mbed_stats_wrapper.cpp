@@ -52,6 +52,11 @@ namespace mbed_lib {
         }
         free(stats);
 
+        // Stacks of all threads together, what a scheduling mode reserves
+        mbed_stats_stack_t total;
+        mbed_stats_stack_get(&total);
+        printf("Stacks: %lu / %lu bytes in %lu threads\r\n", total.max_size, total.reserved_size, total.stack_cnt);
+
         // Grab the heap statistics
         mbed_stats_heap_t heap_stats;
         mbed_stats_heap_get(&heap_stats);
@@ -82,4 +87,29 @@ namespace mbed_lib {
         printf("   DeepSleep: %lld\n", stats.deep_sleep_time);
         printf("Idle: %d%% Usage: %d%%\n\n", idle, usage);
     }
+
+    mbed_stats_cpu_t prev_sleep_stats = {};
+
+    // Sleep and deep sleep residency since the previous call
+    void print_sleep_stats()
+    {
+        mbed_stats_cpu_t stats;
+        mbed_stats_cpu_get(&stats);
+
+        uint64_t up_usec = stats.uptime - prev_sleep_stats.uptime;
+        uint64_t sleep_usec = stats.sleep_time - prev_sleep_stats.sleep_time;
+        uint64_t deep_sleep_usec = stats.deep_sleep_time - prev_sleep_stats.deep_sleep_time;
+        prev_sleep_stats = stats;
+        if (up_usec == 0) {
+            return;
+        }
+
+        uint8_t sleep = (sleep_usec * 100) / up_usec;
+        uint8_t deep_sleep = (deep_sleep_usec * 100) / up_usec;
+        printf("\nSleep Info:\n");
+        printf("Time(us): Up: %lld", up_usec);
+        printf("   Sleep: %lld", sleep_usec);
+        printf("   DeepSleep: %lld\n", deep_sleep_usec);
+        printf("Sleep: %d%% DeepSleep: %d%% Awake: %d%%\n\n", sleep, deep_sleep, 100 - sleep - deep_sleep);
+    }
 } // namespace mbed_lib
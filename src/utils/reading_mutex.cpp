@@ -1,4 +0,0 @@
-#include "utils/reading_mutex.h"
-
-// Define the global reading mutex
-Mutex reading_mutex;
@@ -1,4 +0,0 @@
-#include "utils/sending_mutex.h"
-
-// Define the global reading mutex
-Mutex sending_mutex;